@@ -0,0 +1,25 @@
+// C 日志(clog/glog.c)性能测试适配层
+// glog.h 与 logger.h 的日志级别和宏同名, 因此单独在 C 文件中调用 clog 的日志宏
+#include <stdint.h>
+#include "glog.h"
+
+// 与 logger_bench.cc 中 C++ Logger 场景使用相同的格式串和参数
+void clog_bench_log(int enabled, const char* payload, uint64_t i)
+{
+    if (enabled) {
+        LOG_INFO("%s seq=%llu\n", payload, (unsigned long long)i);
+    } else {
+        LOG_DEBUG("%s seq=%llu\n", payload, (unsigned long long)i);
+    }
+}
+
+// clog 异步文件模式: 日志写入 dir/clog.<日期>.log
+int clog_bench_start(const char* dir)
+{
+    return glog_init(dir, "clog", LV_INFO, 0);
+}
+
+void clog_bench_stop(void)
+{
+    glog_shutdown();
+}
@@ -0,0 +1,916 @@
+// 日志性能测试程序
+// 用法: logger_bench [--scenario 场景|all] [--backend logger|logger_deferred|logger_fmt|clog|clog_async|all]
+//                    [--max-threads N] [--messages N] [--dir 目录]
+// 场景: throughput filtered terminal queue thread_queue filter_cost flush overflow alloc sink binary index compress limit flight wakeup
+// 每个测试用例在独立子进程中运行(单例 Logger、标准输出重定向互不影响), 日志写入 tmpfs 目录;
+// 结果以 JSON Lines 输出到标准输出, 每行一个测试用例, 便于脚本解析和回归对比
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "logger.h"
+
+extern "C" void clog_bench_log(int enabled, const char* payload, uint64_t i);
+extern "C" int clog_bench_start(const char* dir);
+extern "C" void clog_bench_stop(void);
+
+struct BenchOptions {
+    std::string scenario = "all";   // 场景
+    std::string backend = "all";    // 被测日志库
+    int maxThreads = 64;            // 最大生产者线程数
+    uint64_t messages = 200000;     // 每个测试用例的消息总数
+    std::string dir;                // 日志输出目录(默认 tmpfs)
+};
+
+struct BenchResult {
+    std::string scenario;           // 场景名称
+    std::string backend;            // 被测日志库
+    int threads = 1;                // 生产者线程数
+    size_t msgSize = 0;             // 消息负载字节数
+    uint64_t messages = 0;          // 消息总数
+    double seconds = 0;             // 调用方总耗时
+    std::vector<uint64_t> latency;  // 单次调用耗时(纳秒)
+    std::vector<std::pair<std::string, std::string>> extra;    // 场景特有指标
+};
+
+static int resultFd = STDOUT_FILENO;    // 结果输出句柄(子进程可能重定向标准输出)
+static thread_local uint64_t benchAllocs = 0;   // 本线程堆分配次数(alloc 场景统计调用方分配)
+
+// 替换全局 operator new/delete, 统计每个线程的堆分配次数
+void* operator new(size_t size)
+{
+    ++benchAllocs;
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+static inline uint64_t benchNowNs()  // 单调时钟, 纳秒
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t percentile(const std::vector<uint64_t>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+template <typename T>
+static void addExtra(BenchResult& r, const std::string& key, T value)
+{
+    r.extra.push_back(std::make_pair(key, std::to_string(value)));
+}
+
+static void report(BenchResult& r)  // 输出一行 JSON
+{
+    std::sort(r.latency.begin(), r.latency.end());
+    char line[2048];
+    int n = std::snprintf(line, sizeof(line),
+        "{\"scenario\":\"%s\",\"backend\":\"%s\",\"threads\":%d,\"msg_size\":%zu,\"messages\":%llu,\"seconds\":%.6f,"
+        "\"msgs_per_sec\":%.0f,\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu",
+        r.scenario.c_str(), r.backend.c_str(), r.threads, r.msgSize, (unsigned long long)r.messages, r.seconds,
+        r.seconds > 0 ? r.messages / r.seconds : 0.0,
+        (unsigned long long)percentile(r.latency, 0.50),
+        (unsigned long long)percentile(r.latency, 0.99),
+        (unsigned long long)percentile(r.latency, 0.999),
+        (unsigned long long)(r.latency.empty() ? 0 : r.latency.back()));
+    std::string out(line, n);
+    for (auto& kv : r.extra) {
+        out += ",\"" + kv.first + "\":" + kv.second;
+    }
+    out += "}\n";
+    if (write(resultFd, out.data(), out.size()) < 0) std::perror("write");
+}
+
+// 启动 threads 个生产者, 每个线程调用 perThread 次 call(i), 记录每次调用耗时
+template <typename F>
+static BenchResult runProducers(int threads, uint64_t perThread, F call)
+{
+    BenchResult r;
+    r.threads = threads;
+    r.messages = perThread * threads;
+    std::vector<std::vector<uint64_t>> lat(threads);
+    std::vector<std::thread> workers;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::vector<uint64_t>& mine = lat[t];
+            mine.reserve(perThread);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (uint64_t i = 0; i < perThread; ++i) {
+                uint64_t begin = benchNowNs();
+                call(i);
+                mine.push_back(benchNowNs() - begin);
+            }
+        });
+    }
+    while (ready.load() != threads) std::this_thread::yield();
+    uint64_t begin = benchNowNs();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) w.join();
+    r.seconds = (benchNowNs() - begin) / 1e9;
+    for (auto& v : lat) r.latency.insert(r.latency.end(), v.begin(), v.end());
+    return r;
+}
+
+// 不逐次计时的紧凑循环, 用于测量纳秒级调用(单次计时本身开销约数十纳秒)
+template <typename F>
+static double runTight(uint64_t count, F call)
+{
+    uint64_t begin = benchNowNs();
+    for (uint64_t i = 0; i < count; ++i) call(i);
+    return static_cast<double>(benchNowNs() - begin) / count;
+}
+
+static std::vector<int> threadCounts(int maxThreads)
+{
+    std::vector<int> counts;
+    for (int n = 1; n < maxThreads; n *= 2) counts.push_back(n);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+static void removeTree(const std::string& path)  // 删除测试用例目录
+{
+    DIR* d = opendir(path.c_str());
+    if (d == nullptr) {
+        unlink(path.c_str());
+        return;
+    }
+    struct dirent* ent;
+    while ((ent = readdir(d)) != nullptr) {
+        if (std::strcmp(ent->d_name, ".") == 0 || std::strcmp(ent->d_name, "..") == 0) continue;
+        removeTree(path + "/" + ent->d_name);
+    }
+    closedir(d);
+    rmdir(path.c_str());
+}
+
+static void redirectStdout(const std::string& path)  // 子进程标准输出重定向到文件
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    std::fflush(stdout);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+}
+
+// 在独立子进程中运行一个测试用例, caseDir 为该用例的日志目录, 结束后删除
+template <typename F>
+static void runIsolated(const BenchOptions& opts, const std::string& name, F body)
+{
+    std::string caseDir = opts.dir + "/" + name;
+    mkdir(caseDir.c_str(), 0755);
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        resultFd = dup(STDOUT_FILENO);
+        redirectStdout(caseDir + "/stdout.out");    // 日志库自身的提示信息不混入结果
+        body(caseDir);
+        std::fflush(stdout);
+        _exit(0);
+    }
+    int status = 0;
+    if (pid > 0) waitpid(pid, &status, 0);
+    removeTree(caseDir);
+}
+
+static Logger* startLogger(const std::string& dir, LogLevel level, bool terminal, LogQueueMode mode = LOG_QUEUE_SHARED,
+                           LogFileSink sink = LOG_SINK_WRITE)
+{
+    if (terminal) redirectStdout(dir + "/terminal.out");    // 终端输出写入 tmpfs 文件, 模拟管道/journald
+    Logger* logger = Logger::getInstance(dir, "bench", level, terminal);
+    logger->setConsoleColor(1);
+    logger->setQueueMode(mode);
+    logger->setFileSink(sink);
+    logger->start();
+    logger->setLogLevel(level);     // 忽略当前目录 logger.conf 中的级别
+    logger->setConsoleLevel(level);
+    return logger;
+}
+
+static std::string makePayload(size_t size)
+{
+    std::string payload(size, 'x');
+    for (size_t i = 0; i < size; ++i) payload[i] = static_cast<char>('a' + i % 26);
+    return payload;
+}
+
+static bool wantBackend(const BenchOptions& opts, const char* backend)
+{
+    return opts.backend == "all" || opts.backend == backend;
+}
+
+// 单个 Logger/clog 用例: 每次调用写一条 "<payload> seq=<i>"
+static void runLoggingCase(const BenchOptions& opts, const std::string& scenario, const std::string& backend,
+                           int threads, size_t size, bool filtered, bool terminal, LogQueueMode mode = LOG_QUEUE_SHARED)
+{
+    std::string name = scenario + "_" + backend + "_t" + std::to_string(threads) + "_s" + std::to_string(size) + "_q" + std::to_string(mode);
+    runIsolated(opts, name, [&](const std::string& dir) {
+        const std::string payload = makePayload(size);
+        const char* text = payload.c_str();
+        uint64_t perThread = std::max<uint64_t>(1, opts.messages / threads);
+        BenchResult r;
+        if (backend == "clog") {
+            redirectStdout(dir + "/clog.out");  // clog 同步模式只能输出到标准输出
+            r = runProducers(threads, perThread, [text](uint64_t i) { clog_bench_log(1, text, i); });
+        } else if (backend == "clog_async") {   // clog 异步文件模式
+            clog_bench_start(dir.c_str());
+            r = runProducers(threads, perThread, [text](uint64_t i) { clog_bench_log(1, text, i); });
+        } else {
+            startLogger(dir, LV_INFO, terminal, mode);
+            bool deferred = backend == "logger_deferred";
+            if (backend == "logger_fmt" && filtered) {
+                r = runProducers(threads, perThread, [text](uint64_t i) { LOGF(LV_DEBUG, "{} seq={}", text, i); });
+            } else if (backend == "logger_fmt") {
+                r = runProducers(threads, perThread, [text](uint64_t i) { LOGF(LV_INFO, "{} seq={}", text, i); });
+            } else if (deferred && filtered) {
+                r = runProducers(threads, perThread, [text](uint64_t i) { LOG_DEFERRED(LV_DEBUG, "%s seq=%llu", text, (unsigned long long)i); });
+            } else if (deferred) {
+                r = runProducers(threads, perThread, [text](uint64_t i) { LOG_DEFERRED(LV_INFO, "%s seq=%llu", text, (unsigned long long)i); });
+            } else if (filtered) {
+                r = runProducers(threads, perThread, [text](uint64_t i) { LOG_EAGER(LV_DEBUG, "%s seq=%llu", text, (unsigned long long)i); });
+            } else {
+                r = runProducers(threads, perThread, [text](uint64_t i) { LOG_EAGER(LV_INFO, "%s seq=%llu", text, (unsigned long long)i); });
+            }
+        }
+        if (backend != "clog") {    // 停止日志并写出队列中剩余的日志, 记录排空耗时
+            uint64_t begin = benchNowNs();
+            if (backend == "clog_async") clog_bench_stop();
+            else Logger::getInstance()->shutdown();
+            addExtra(r, "drain_ms", (benchNowNs() - begin) / 1e6);
+        }
+        r.scenario = scenario;
+        r.backend = backend;
+        r.msgSize = size;
+        addExtra(r, "filtered", filtered ? 1 : 0);
+        addExtra(r, "terminal", terminal ? 1 : 0);
+        addExtra(r, "per_thread_queue", mode == LOG_QUEUE_PER_THREAD ? 1 : 0);
+        report(r);
+    });
+}
+
+// 场景: 各日志库在不同线程数、消息大小下的吞吐和调用延迟
+static void benchThroughput(const BenchOptions& opts)
+{
+    const size_t sizes[] = { 16, 128, 1024 };
+    const char* backends[] = { "logger", "logger_deferred", "logger_fmt", "clog", "clog_async" };
+    for (const char* backend : backends) {
+        if (!wantBackend(opts, backend)) continue;
+        for (size_t size : sizes) {
+            for (int threads : threadCounts(opts.maxThreads)) {
+                runLoggingCase(opts, "throughput", backend, threads, size, false, false);
+            }
+        }
+    }
+}
+
+// 场景: 级别被过滤的调用(clog 不参与)
+static void benchFiltered(const BenchOptions& opts)
+{
+    const char* backends[] = { "logger", "logger_deferred", "logger_fmt" };
+    for (const char* backend : backends) {
+        if (!wantBackend(opts, backend)) continue;
+        for (int threads : threadCounts(opts.maxThreads)) {
+            runLoggingCase(opts, "filtered", backend, threads, 128, true, false);
+        }
+    }
+}
+
+// 场景: 同时输出到终端(标准输出重定向到 tmpfs 文件); clog 同步模式只输出到标准输出, 见 throughput
+static void benchTerminal(const BenchOptions& opts)
+{
+    const char* backends[] = { "logger", "logger_deferred" };
+    for (const char* backend : backends) {
+        if (!wantBackend(opts, backend)) continue;
+        for (int threads : threadCounts(opts.maxThreads)) {
+            runLoggingCase(opts, "terminal", backend, threads, 128, false, true);
+        }
+    }
+}
+
+// 场景: 共享多生产者队列 vs 线程私有单生产者队列, 观察单次调用开销随线程数的变化
+static void benchThreadQueue(const BenchOptions& opts)
+{
+    const char* backends[] = { "logger", "logger_deferred" };
+    for (const char* backend : backends) {
+        if (!wantBackend(opts, backend)) continue;
+        for (int threads : threadCounts(opts.maxThreads)) {
+            runLoggingCase(opts, "thread_queue", backend, threads, 16, false, false, LOG_QUEUE_SHARED);
+            runLoggingCase(opts, "thread_queue", backend, threads, 16, false, false, LOG_QUEUE_PER_THREAD);
+        }
+    }
+}
+
+// 场景: 无锁环形队列 vs 互斥锁 + std::queue(原实现)的入队开销
+static void benchQueue(const BenchOptions& opts)
+{
+    const std::string text = "[bench.cc:1] ring buffer enqueue benchmark message";
+    for (int threads : threadCounts(opts.maxThreads)) {
+        runIsolated(opts, "queue_ring_t" + std::to_string(threads), [&](const std::string&) {
+            LogRingBuffer<LogMessage> ring(LOG_QUEUE_CAPACITY);
+            std::atomic<bool> stop{false};
+            std::thread consumer([&]() {
+                LogMessage msg;
+                while (!stop.load(std::memory_order_acquire) || !ring.empty()) {
+                    if (!ring.tryPop(msg)) std::this_thread::yield();
+                }
+            });
+            BenchResult r = runProducers(threads, std::max<uint64_t>(1, opts.messages / threads), [&](uint64_t) {
+                LogMessage m;
+                m.level = LV_INFO;
+                std::memcpy(m.inlineData, text.data(), text.size());
+                m.length = static_cast<uint32_t>(text.size());
+                ring.push(std::move(m));
+            });
+            stop.store(true, std::memory_order_release);
+            consumer.join();
+            r.scenario = "queue";
+            r.backend = "ring_mpsc";
+            r.msgSize = text.size();
+            report(r);
+        });
+        runIsolated(opts, "queue_mutex_t" + std::to_string(threads), [&](const std::string&) {
+            std::mutex mtx;
+            std::queue<LogMessage> queue;
+            std::atomic<bool> stop{false};
+            std::thread consumer([&]() {
+                for (;;) {
+                    bool done = stop.load(std::memory_order_acquire);
+                    std::unique_lock<std::mutex> lock(mtx);
+                    if (queue.empty()) {
+                        lock.unlock();
+                        if (done) break;
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    queue.pop();
+                }
+            });
+            BenchResult r = runProducers(threads, std::max<uint64_t>(1, opts.messages / threads), [&](uint64_t) {
+                LogMessage m;
+                m.level = LV_INFO;
+                std::memcpy(m.inlineData, text.data(), text.size());
+                m.length = static_cast<uint32_t>(text.size());
+                std::unique_lock<std::mutex> lock(mtx);
+                queue.push(std::move(m));
+            });
+            stop.store(true, std::memory_order_release);
+            consumer.join();
+            r.scenario = "queue";
+            r.backend = "mutex_queue";
+            r.msgSize = text.size();
+            report(r);
+        });
+    }
+}
+
+// 场景: 被级别过滤的单次调用开销(纳秒), 对照旧宏先格式化再由后台线程丢弃的行为
+static void benchFilterCost(const BenchOptions& opts)
+{
+    runIsolated(opts, "filter_cost", [&](const std::string& dir) {
+        Logger* logger = startLogger(dir, LV_INFO, false);
+        uint64_t count = opts.messages * 10;
+        BenchResult r;
+        r.scenario = "filter_cost";
+        r.backend = "logger";
+        r.messages = count;
+        double ns = runTight(count, [](uint64_t i) {
+            LOG_DEBUG("filtered message %llu value=%f", (unsigned long long)i, 3.14);
+        });
+        r.seconds = ns * count / 1e9;
+        addExtra(r, "ns_per_call", ns);
+        report(r);
+
+        BenchResult module;     // 命名日志器: 其他模块开启 DEBUG 时, 本模块被过滤的调用开销
+        module.scenario = "filter_cost";
+        module.backend = "logger_module";
+        module.messages = count;
+        LogModule& quiet = logger->getModule("bench_quiet");
+        logger->setModuleLevel("bench_verbose", LV_DEBUG);
+        ns = runTight(count, [&quiet](uint64_t i) {
+            MLOG_DEBUG(quiet, "filtered message %llu value=%f", (unsigned long long)i, 3.14);
+        });
+        module.seconds = ns * count / 1e9;
+        addExtra(module, "ns_per_call", ns);
+        report(module);
+
+        BenchResult legacy;
+        legacy.scenario = "filter_cost";
+        legacy.backend = "logger_legacy";
+        legacy.messages = opts.messages;
+        logger->setLogLevel(LV_TRACE);      // 模拟旧实现: 调用方不判断级别, 由后台线程丢弃
+        logger->setConsoleLevel(LV_INFO);
+        logger->setOutputToTerminal(false);
+        ns = runTight(opts.messages, [logger](uint64_t i) {
+            logger->log(LV_DEBUG, "[%s:%d] filtered message %llu value=%f", __FILENAME__, __LINE__, (unsigned long long)i, 3.14);
+        });
+        legacy.seconds = ns * opts.messages / 1e9;
+        addExtra(legacy, "ns_per_call", ns);
+        report(legacy);
+    });
+}
+
+// 场景: 限流宏的调用开销(绝大多数调用被抑制), 以及实际写入的条数
+static void benchLimit(const BenchOptions& opts)
+{
+    const char* names[] = { "every_n", "every_ms", "rate_limited" };
+    for (int kind = 0; kind < 3; ++kind) {
+        runIsolated(opts, std::string("limit_") + names[kind], [&](const std::string& dir) {
+            Logger* logger = startLogger(dir, LV_INFO, false);
+            uint64_t count = opts.messages * 10;
+            BenchResult r;
+            r.scenario = "limit";
+            r.backend = names[kind];
+            r.messages = count;
+            double ns = runTight(count, [kind](uint64_t i) {
+                if (kind == 0) LOG_EVERY_N(LV_WARN, 1000, "hot loop warning %llu value=%f", (unsigned long long)i, 3.14);
+                else if (kind == 1) LOG_EVERY_MS(LV_WARN, 100, "hot loop warning %llu value=%f", (unsigned long long)i, 3.14);
+                else LOG_RATE_LIMITED(LV_WARN, 100, 10, "hot loop warning %llu value=%f", (unsigned long long)i, 3.14);
+            });
+            logger->flush();
+            r.seconds = ns * count / 1e9;
+            addExtra(r, "ns_per_call", ns);
+            addExtra(r, "written", logger->stats().written[LV_WARN]);
+            report(r);
+        });
+    }
+}
+
+// 场景: 飞行记录器关闭/开启时低于文件级别的 DEBUG 日志调用耗时(三种宏), 以及 ERROR 触发转储的条数
+static void benchFlight(const BenchOptions& opts)
+{
+    const char* macros[] = { "eager", "deferred", "fmt" };
+    for (int recorder = 0; recorder < 2; ++recorder) {
+        for (int macro = 0; macro < 3; ++macro) {
+            std::string name = std::string("flight_") + (recorder ? "on_" : "off_") + macros[macro];
+            runIsolated(opts, name, [&](const std::string& dir) {
+                Logger* logger = startLogger(dir, LV_INFO, false);
+                if (recorder) logger->setFlightRecorder(4096, LV_DEBUG);
+                uint64_t count = opts.messages;
+                BenchResult r;
+                r.scenario = std::string("flight_") + (recorder ? "on" : "off");
+                r.backend = macros[macro];
+                r.messages = count;
+                double ns = runTight(count, [macro](uint64_t i) {
+                    if (macro == 0) LOG_EAGER(LV_DEBUG, "request %llu state=%d latency=%f", (unsigned long long)i, 3, 0.25);
+                    else if (macro == 1) LOG_DEFERRED(LV_DEBUG, "request %llu state=%d latency=%f", (unsigned long long)i, 3, 0.25);
+                    else LOGF(LV_DEBUG, "request {} state={} latency={}", (unsigned long long)i, 3, 0.25);
+                });
+                LOG_ERROR("flight benchmark error");
+                logger->flush();
+                r.seconds = ns * count / 1e9;
+                addExtra(r, "ns_per_call", ns);
+                addExtra(r, "written", logger->stats().written[LV_ERROR]);
+                report(r);
+            });
+        }
+    }
+}
+
+static double processCpuMs()  // 本进程累计 CPU 时间(用户态 + 内核态, 毫秒)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+}
+
+// 场景: 日志线程固定轮询与自适应等待下, 稀疏日志的入队到写出延迟, 以及空闲时的 CPU 占用
+static void benchWakeup(const BenchOptions& opts)
+{
+    const char* names[] = { "adaptive", "poll" };
+    for (int mode = LOG_WAIT_ADAPTIVE; mode <= LOG_WAIT_POLL; ++mode) {
+        runIsolated(opts, std::string("wakeup_") + names[mode], [&](const std::string& dir) {
+            Logger* logger = startLogger(dir, LV_INFO, false);
+            logger->setConsumerWait(static_cast<LogWaitMode>(mode));
+            LOG_SLEEP(50);
+            double cpuBegin = processCpuMs();
+            LOG_SLEEP(1000);    // 空闲 1 秒
+            double idleCpu = processCpuMs() - cpuBegin;
+            uint64_t count = std::min<uint64_t>(opts.messages, 500);
+            BenchResult r = runProducers(1, count, [](uint64_t i) {
+                LOG_INFO("sparse message %llu", (unsigned long long)i);
+                usleep(1000);   // 每毫秒一条, 日志线程每条之间都会进入空闲等待
+            });
+            logger->flush();
+            LogStats stats = logger->stats();
+            r.scenario = "wakeup";
+            r.backend = names[mode];
+            addExtra(r, "enqueue_to_write_p50_ns", stats.latency.percentile(0.50));
+            addExtra(r, "enqueue_to_write_p99_ns", stats.latency.percentile(0.99));
+            addExtra(r, "idle_cpu_ms_per_s", idleCpu);
+            addExtra(r, "parks", stats.consumerParks);
+            report(r);
+        });
+    }
+}
+
+// 场景: 不同刷盘策略下的写入系统调用次数与批大小
+static void benchFlush(const BenchOptions& opts)
+{
+    const char* names[] = { "batch", "message", "bytes", "interval", "level" };
+    for (int mode = LOG_FLUSH_BATCH; mode <= LOG_FLUSH_LEVEL; ++mode) {
+        runIsolated(opts, std::string("flush_") + names[mode], [&](const std::string& dir) {
+            Logger* logger = startLogger(dir, LV_INFO, false);
+            LogFlushPolicy policy;
+            policy.mode = static_cast<LogFlushMode>(mode);
+            policy.intervalMs = 50;
+            logger->setFlushPolicy(policy);
+            LOG_SLEEP(50);
+            uint64_t count = std::min<uint64_t>(opts.messages, LOG_QUEUE_CAPACITY / 2);
+            LogWriterStats before = logger->writerStats();
+            BenchResult r = runProducers(1, count, [](uint64_t i) {
+                LOG_INFO("flush policy benchmark message %llu payload=%d", (unsigned long long)i, 42);
+            });
+            LOG_SLEEP(500);     // 等待日志线程写完
+            LogWriterStats after = logger->writerStats();
+            uint64_t batches = after.batches - before.batches;
+            r.scenario = std::string("flush_") + names[mode];
+            r.backend = "logger";
+            addExtra(r, "syscalls", after.syscalls - before.syscalls);
+            addExtra(r, "bytes", after.bytes - before.bytes);
+            addExtra(r, "avg_batch_bytes", batches ? static_cast<double>(after.bytes - before.bytes) / batches : 0.0);
+            report(r);
+        });
+    }
+}
+
+// 场景: write 与 mmap 两种文件输出方式的吞吐、系统调用次数和排空耗时
+static void benchSink(const BenchOptions& opts)
+{
+    const char* names[] = { "write", "mmap" };
+    const int threadCases[] = { 1, opts.maxThreads };
+    for (int sink = LOG_SINK_WRITE; sink <= LOG_SINK_MMAP; ++sink) {
+        for (int threads : threadCases) {
+            runIsolated(opts, std::string("sink_") + names[sink] + "_t" + std::to_string(threads), [&](const std::string& dir) {
+                Logger* logger = startLogger(dir, LV_INFO, false, LOG_QUEUE_SHARED, static_cast<LogFileSink>(sink));
+                const std::string payload = makePayload(128);
+                const char* text = payload.c_str();
+                LogWriterStats before = logger->writerStats();
+                BenchResult r = runProducers(threads, std::max<uint64_t>(1, opts.messages / threads), [text](uint64_t i) {
+                    LOG_EAGER(LV_INFO, "%s seq=%llu", text, (unsigned long long)i);
+                });
+                uint64_t begin = benchNowNs();
+                logger->flush();
+                addExtra(r, "drain_ms", (benchNowNs() - begin) / 1e6);
+                LogWriterStats after = logger->writerStats();
+                r.scenario = std::string("sink_") + names[sink];
+                r.backend = "logger";
+                r.msgSize = payload.size();
+                addExtra(r, "syscalls", after.syscalls - before.syscalls);
+                addExtra(r, "bytes", after.bytes - before.bytes);
+                report(r);
+            });
+        }
+    }
+}
+
+// 目录中所有文件的总字节数
+static uint64_t directoryBytes(const std::string& dir)
+{
+    uint64_t total = 0;
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) return 0;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != nullptr) {
+        struct stat st;
+        std::string path = dir + "/" + ent->d_name;
+        if (ent->d_name[0] != '.' && stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) total += st.st_size;
+    }
+    closedir(d);
+    return total;
+}
+
+// 场景: 文本与二进制文件格式每条日志的字节数, 以及二进制格式的解码速度(只解析 / 解析并还原文本)
+static void benchBinary(const BenchOptions& opts)
+{
+    const char* names[] = { "text", "binary" };
+    for (int format = LOG_FORMAT_TEXT; format <= LOG_FORMAT_BINARY; ++format) {
+        runIsolated(opts, std::string("binary_") + names[format], [&](const std::string& dir) {
+            Logger* logger = Logger::getInstance(dir, "bench", LV_INFO, false);
+            logger->setFileFormat(static_cast<LogFileFormat>(format));
+            logger->start();
+            logger->setLogLevel(LV_INFO);
+            BenchResult r = runProducers(1, opts.messages, [](uint64_t i) {
+                LOG_DEFERRED(LV_INFO, "request %llu from %s finished status=%d bytes=%u took %.3f ms",
+                             (unsigned long long)i, "10.0.0.1", 200, (unsigned)(i % 4096), (i % 1000) * 0.125);
+            });
+            logger->shutdown();
+            uint64_t bytes = directoryBytes(dir);
+            r.scenario = "binary";
+            r.backend = names[format];
+            addExtra(r, "file_bytes", bytes);
+            addExtra(r, "bytes_per_msg", static_cast<double>(bytes) / opts.messages);
+            if (format == LOG_FORMAT_BINARY) {
+                std::ifstream in((dir + "/bench." + LogTimeFormatter::date(LogClock::nowNanos()) + ".blog").c_str(), std::ios::binary);
+                std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                uint64_t records = 0;
+                uint64_t begin = benchNowNs();
+                LogBinaryReader scan(data.data(), data.size());
+                while (scan.next()) ++records;
+                double scanSec = (benchNowNs() - begin) / 1e9;
+                std::string text;
+                begin = benchNowNs();
+                LogBinaryReader reader(data.data(), data.size());
+                while (reader.next()) {
+                    text.clear();
+                    reader.format(text);
+                }
+                double formatSec = (benchNowNs() - begin) / 1e9;
+                addExtra(r, "decoded", records);
+                addExtra(r, "scan_msgs_per_sec", scanSec > 0 ? records / scanSec : 0.0);
+                addExtra(r, "decode_msgs_per_sec", formatSec > 0 ? records / formatSec : 0.0);
+                addExtra(r, "decode_mb_per_sec", formatSec > 0 ? data.size() / formatSec / 1e6 : 0.0);
+            }
+            report(r);
+        });
+    }
+}
+
+// 二进制格式 + 小索引块: 每个索引块以文件头开始并清空调用点字典, 同一延迟调用点的调用点记录反复跨块重写;
+// 解码全部记录并逐条核对内容, mismatches 应为 0
+static void benchBinaryBlocks(const BenchOptions& opts)
+{
+    runIsolated(opts, "binary_blocks", [&](const std::string& dir) {
+        Logger* logger = Logger::getInstance(dir, "bench", LV_INFO, false);
+        logger->setFileFormat(LOG_FORMAT_BINARY);
+        logger->setIndexInterval(256);
+        logger->start();
+        logger->setLogLevel(LV_INFO);
+        logger->flush();    // 等待日志线程应用格式和索引配置
+        BenchResult r = runProducers(1, opts.messages, [](uint64_t i) {
+            // 格式串较长: 调用点记录远大于按参数估算的事件记录长度
+            LOG_DEFERRED(LV_INFO, "request %llu from %s finished; upstream=backend-pool-primary route=/api/v1/orders/search "
+                                  "cache=miss retries=0 trace=0000000000000000 span=00000000 tenant=default region=local", (unsigned long long)i, "10.0.0.1");
+        });
+        logger->shutdown();
+        std::ifstream in((dir + "/bench." + LogTimeFormatter::date(LogClock::nowNanos()) + ".blog").c_str(), std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        uint64_t records = 0;
+        uint64_t mismatches = 0;
+        std::string text;
+        LogBinaryReader reader(data.data(), data.size());
+        while (reader.next()) {
+            text.clear();
+            reader.format(text);
+            std::string expected = "request " + std::to_string(records) + " from 10.0.0.1 finished";
+            if (text.find(expected) == std::string::npos) ++mismatches;
+            ++records;
+        }
+        if (records != opts.messages) mismatches += records > opts.messages ? records - opts.messages : opts.messages - records;
+        r.scenario = "binary";
+        r.backend = "blocks";
+        addExtra(r, "decoded", records);
+        addExtra(r, "mismatches", mismatches);
+        report(r);
+        if (mismatches > 0) std::fprintf(stderr, "binary_blocks: %llu mismatched records\n", (unsigned long long)mismatches);
+    });
+}
+
+// 场景: 生成索引文件对写入的影响, 以及按索引查询中间 5% 时间段需要读取的文件比例
+static void benchIndex(const BenchOptions& opts)
+{
+    const uint64_t intervals[] = { 0, 64 * 1024 };
+    for (uint64_t interval : intervals) {
+        std::string name = interval == 0 ? "off" : "64k";
+        runIsolated(opts, "index_" + name, [&](const std::string& dir) {
+            Logger* logger = startLogger(dir, LV_INFO, false);
+            logger->setIndexInterval(interval);
+            logger->flush();    // 等待日志线程应用索引配置
+            const std::string payload = makePayload(64);
+            const char* text = payload.c_str();
+            BenchResult r = runProducers(1, opts.messages, [text](uint64_t i) {
+                LOG_EAGER(i % 1000 == 0 ? LV_ERROR : LV_INFO, "%s seq=%llu", text, (unsigned long long)i);
+            });
+            uint64_t begin = benchNowNs();
+            logger->shutdown();
+            addExtra(r, "drain_ms", (benchNowNs() - begin) / 1e6);
+            std::string file = dir + "/bench." + LogTimeFormatter::date(LogClock::nowNanos()) + ".log";
+            std::vector<LogIndexEntry> entries;
+            int64_t fileBytes = LogArchiver::fileSize(file);
+            r.scenario = "index";
+            r.backend = name;
+            r.msgSize = payload.size();
+            addExtra(r, "file_bytes", fileBytes);
+            if (interval > 0 && logReadIndex(file + ".idx", entries) && !entries.empty() && fileBytes > 0) {
+                int64_t first = entries.front().minNanos;
+                int64_t span = entries.back().maxNanos - first;
+                int64_t from = first + span * 45 / 100;
+                int64_t to = first + span * 50 / 100;
+                uint64_t indexed = 0;
+                uint64_t selected = 0;
+                for (const LogIndexEntry& e : entries) {
+                    indexed += e.length;
+                    if (e.maxNanos >= from && e.minNanos < to) selected += e.length;
+                }
+                selected += fileBytes - indexed;    // 未被索引覆盖的部分需要顺序扫描
+                addExtra(r, "index_bytes", LogArchiver::fileSize(file + ".idx"));
+                addExtra(r, "index_entries", entries.size());
+                addExtra(r, "window_read_ratio", static_cast<double>(selected) / fileBytes);
+            }
+            report(r);
+        });
+    }
+}
+
+// 场景: 流式压缩对吞吐、排空耗时和写入磁盘字节数的影响
+static void benchCompress(const BenchOptions& opts)
+{
+    const char* names[] = { "off", "stream" };
+    for (int compress = 0; compress <= 1; ++compress) {
+        runIsolated(opts, std::string("compress_") + names[compress], [&](const std::string& dir) {
+            Logger* logger = startLogger(dir, LV_INFO, false);
+            logger->setStreamCompression(compress != 0);
+            logger->flush();    // 等待日志线程切换到压缩文件
+            const std::string payload = makePayload(64);
+            const char* text = payload.c_str();
+            LogWriterStats before = logger->writerStats();
+            BenchResult r = runProducers(1, opts.messages, [text](uint64_t i) {
+                LOG_EAGER(LV_INFO, "%s seq=%llu status=%d", text, (unsigned long long)i, (int)(i % 7 == 0 ? 500 : 200));
+            });
+            uint64_t begin = benchNowNs();
+            logger->flush();
+            addExtra(r, "drain_ms", (benchNowNs() - begin) / 1e6);
+            LogWriterStats after = logger->writerStats();
+            logger->shutdown();
+            r.scenario = "compress";
+            r.backend = names[compress];
+            r.msgSize = payload.size();
+            addExtra(r, "syscalls", after.syscalls - before.syscalls);
+            addExtra(r, "disk_bytes", directoryBytes(dir));
+            report(r);
+        });
+    }
+}
+
+// 场景: 队列写满时各溢出策略的调用方开销与丢弃数
+static void benchOverflow(const BenchOptions& opts)
+{
+    const char* names[] = { "block", "drop_newest", "drop_oldest", "drop_below_level" };
+    for (int policy = LOG_OVERFLOW_BLOCK; policy <= LOG_OVERFLOW_DROP_BELOW_LEVEL; ++policy) {
+        runIsolated(opts, std::string("overflow_") + names[policy], [&](const std::string& dir) {
+            Logger* logger = Logger::getInstance(dir, "bench", LV_INFO, false);
+            logger->setQueueCapacity(1024);     // 小队列, 确保触发溢出
+            logger->start();
+            logger->setLogLevel(LV_INFO);
+            logger->setOverflowPolicy(static_cast<LogOverflowPolicy>(policy), LV_WARN);
+            int threads = std::min(opts.maxThreads, 8);
+            BenchResult r = runProducers(threads, std::max<uint64_t>(1, opts.messages / threads), [](uint64_t i) {
+                if (i % 64 == 0) LOG_WARN("overflow benchmark warning %llu", (unsigned long long)i);
+                else LOG_INFO("overflow benchmark message %llu", (unsigned long long)i);
+            });
+            r.scenario = std::string("overflow_") + names[policy];
+            r.backend = "logger";
+            addExtra(r, "dropped", logger->droppedCount());
+            report(r);
+        });
+    }
+}
+
+// 场景: 预热后调用方每次日志调用的堆分配次数(期望为 0, 超长日志使用溢出块池)
+static void benchAlloc(const BenchOptions& opts)
+{
+    const size_t sizes[] = {16, 128, 1024, 8192};
+    const LogQueueMode modes[] = {LOG_QUEUE_SHARED, LOG_QUEUE_PER_THREAD};
+    for (LogQueueMode mode : modes) {
+        for (size_t size : sizes) {
+            for (int deferred = 0; deferred < 2; ++deferred) {
+                std::string backend = deferred ? "logger_deferred" : "logger";
+                if (!wantBackend(opts, backend.c_str())) continue;
+                std::string name = "alloc_" + backend + "_s" + std::to_string(size) + "_q" + std::to_string(mode);
+                runIsolated(opts, name, [&](const std::string& dir) {
+                    const std::string payload = makePayload(size);
+                    const char* text = payload.c_str();
+                    Logger* logger = startLogger(dir, LV_INFO, false, mode);
+                    auto call = [&](uint64_t i) {
+                        if (deferred) LOG_DEFERRED(LV_INFO, "%s seq=%llu", text, (unsigned long long)i);
+                        else LOG_EAGER(LV_INFO, "%s seq=%llu", text, (unsigned long long)i);
+                    };
+                    const uint64_t batch = 32;  // 每批之后等待日志线程归还溢出块, 只统计调用本身
+                    for (uint64_t i = 0; i < 4 * batch; ++i) {  // 预热: 注册线程队列、填充溢出块池
+                        call(i);
+                        if (i % batch == batch - 1) logger->flush();
+                    }
+                    uint64_t count = std::max<uint64_t>(batch, std::min<uint64_t>(opts.messages, 4096));
+                    uint64_t allocs = 0;
+                    uint64_t begin = benchNowNs();
+                    for (uint64_t i = 0; i < count; ++i) {
+                        uint64_t before = benchAllocs;
+                        call(i);
+                        allocs += benchAllocs - before;
+                        if (i % batch == batch - 1) logger->flush();
+                    }
+                    BenchResult r;
+                    r.seconds = (benchNowNs() - begin) / 1e9;
+                    r.messages = count;
+                    r.scenario = "alloc";
+                    r.backend = backend;
+                    r.msgSize = size;
+                    addExtra(r, "allocs_per_call", static_cast<double>(allocs) / count);
+                    addExtra(r, "per_thread_queue", mode == LOG_QUEUE_PER_THREAD ? 1 : 0);
+                    report(r);
+                });
+            }
+        }
+    }
+}
+
+static std::string defaultBenchDir()  // 优先写入 tmpfs, 避免磁盘抖动影响结果
+{
+    return access("/dev/shm", W_OK) == 0 ? "/dev/shm/logger_bench" : "/tmp/logger_bench";
+}
+
+static void usage(const char* prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [--scenario all|throughput|filtered|terminal|queue|thread_queue|filter_cost|flush|overflow|alloc|sink|binary|index|compress|limit|flight|wakeup]\n"
+        "          [--backend all|logger|logger_deferred|logger_fmt|clog|clog_async] [--max-threads N] [--messages N] [--dir DIR]\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--scenario") opts.scenario = value;
+        else if (arg == "--backend") opts.backend = value;
+        else if (arg == "--max-threads") opts.maxThreads = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--messages") opts.messages = std::max<uint64_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        else if (arg == "--dir") opts.dir = value;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opts.dir.empty()) opts.dir = defaultBenchDir();
+    mkdir(opts.dir.c_str(), 0755);
+
+    const std::string& s = opts.scenario;
+    if (s == "all" || s == "throughput") benchThroughput(opts);
+    if (s == "all" || s == "filtered") benchFiltered(opts);
+    if (s == "all" || s == "terminal") benchTerminal(opts);
+    if (s == "all" || s == "queue") benchQueue(opts);
+    if (s == "all" || s == "thread_queue") benchThreadQueue(opts);
+    if (s == "all" || s == "filter_cost") benchFilterCost(opts);
+    if (s == "all" || s == "flush") benchFlush(opts);
+    if (s == "all" || s == "overflow") benchOverflow(opts);
+    if (s == "all" || s == "alloc") benchAlloc(opts);
+    if (s == "all" || s == "sink") benchSink(opts);
+    if (s == "all" || s == "binary") {
+        benchBinary(opts);
+        benchBinaryBlocks(opts);
+    }
+    if (s == "all" || s == "index") benchIndex(opts);
+    if (s == "all" || s == "compress") benchCompress(opts);
+    if (s == "all" || s == "limit") benchLimit(opts);
+    if (s == "all" || s == "flight") benchFlight(opts);
+    if (s == "all" || s == "wakeup") benchWakeup(opts);
+    return 0;
+}
@@ -1,3 +1,4 @@
 #!/bin/bash
 
-gcc main.c glog.c -o main
\ No newline at end of file
+gcc main.c glog.c -o main -lpthread
+gcc main_async.c glog.c -o main_async -lpthread
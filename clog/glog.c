@@ -1,9 +1,80 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/stat.h>
 #include <threads.h>
 #include "glog.h"
 #include <pthread.h>
 
+// 异步模式队列容量(槽位数, 2 的幂)
+#ifndef GLOG_QUEUE_CAPACITY
+#define GLOG_QUEUE_CAPACITY 65536
+#endif
+// 槽位大小: 整行不超过槽位内联区时直接拷贝, 超出时使用堆内存
+#ifndef GLOG_SLOT_SIZE
+#define GLOG_SLOT_SIZE 256
+#endif
+// 线程私有格式化缓冲区大小
+#ifndef GLOG_LINE_MAX
+#define GLOG_LINE_MAX 4096
+#endif
+// 写线程的文件/终端写缓冲区大小, 满或一批结束时调用一次 write
+#ifndef GLOG_WRITE_BUFFER
+#define GLOG_WRITE_BUFFER (256 * 1024)
+#endif
+// 写线程空闲时先让出 CPU 的次数, 之后休眠(最长 100 毫秒), 生产者在写线程休眠时唤醒
+#ifndef GLOG_WAIT_YIELD
+#define GLOG_WAIT_YIELD 20
+#endif
+
+static const char* const level_names[] = { "trace", "debug", "info ", "warn ", "error", "fatal" };
+static const char* const level_colors[] = { "\033[0;37m", "\033[0;36m", "\033[0;32m", "\033[0;33m", "\033[0;31m", "\033[0;35m" };
+
+// 队列槽位: seq 为 pos 表示空闲, pos + 1 表示已发布(无锁多生产者单消费者环形队列)
+struct glog_slot {
+    uint64_t seq;           // 槽位序号(原子访问)
+    uint32_t length;        // 整行长度(含换行)
+    uint16_t text_offset;   // 内容在行内的偏移(终端着色时替换级别部分)
+    uint8_t level;          // 日志级别
+    uint8_t reserved;
+    int64_t seconds;        // 日志时间(纪元秒, 日期切换用)
+    char* heap;             // 超长行(由写线程释放)
+    char data[GLOG_SLOT_SIZE - 32];
+};
+
+struct glog_buffer {
+    int fd;
+    size_t used;
+    char data[GLOG_WRITE_BUFFER];
+};
+
+static struct {
+    int async;                  // 1: 异步文件模式(原子访问)
+    int level;                  // 最低输出级别(原子访问)
+    struct glog_slot* slots;    // 槽位数组(首次 glog_init 时分配, 之后不释放, 避免与仍在写入的线程竞争)
+    uint64_t mask;
+    uint64_t enqueue_pos __attribute__((aligned(64)));  // 写位置(生产者 CAS)
+    uint64_t dequeue_pos __attribute__((aligned(64)));  // 读位置(仅写线程)
+    uint64_t written_pos;       // 已写出的位置(glog_flush 等待)
+    int running;                // 写线程是否继续运行(原子访问)
+    int parked;                 // 写线程是否准备休眠(原子访问)
+    int producers __attribute__((aligned(64)));     // 正在异步写入的调用方线程数(原子访问)
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    char dir[512];
+    char module[128];
+    int to_stdout;
+    int64_t next_midnight;      // 下一个零点(纪元秒), 到达后切换日志文件
+    struct glog_buffer* file;   // 日志文件写缓冲区
+    struct glog_buffer* out;    // 标准输出写缓冲区
+} g = { .level = LV_TRACE, .mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
 void glog(const char *format, ...)
 {
     va_list args;
@@ -12,39 +83,370 @@ void glog(const char *format, ...)
     va_end(args);
 }
 
-// 获取当前日期和时间，格式为YYYY-MM-DD HH:MM:SS
-void getDateTime(char* buffer, int size) 
+// 写入 "[YYYY-MM-DD HH:MM:SS.mmm] [级别] "(同步模式沿用原格式, 不带毫秒), 返回长度
+// 同一秒内复用线程私有的日期缓存, 只在秒变化时调用 localtime_r
+static int format_prefix(char* p, const struct timespec* ts, enum LogLevel lv, int colored, int millis, int* text_offset)
 {
-    time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
-    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", tm_info);
-    buffer[size - 1] = '\0';
+    static __thread time_t cached_second = -1;
+    static __thread char cached_text[24];
+    if (ts->tv_sec != cached_second) {
+        struct tm tm_info;
+        localtime_r(&ts->tv_sec, &tm_info);
+        strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S", &tm_info);
+        cached_second = ts->tv_sec;
+    }
+    char* begin = p;
+    *p++ = '[';
+    memcpy(p, cached_text, 19);
+    p += 19;
+    if (millis) {
+        int ms = (int)(ts->tv_nsec / 1000000);
+        *p++ = '.';
+        *p++ = (char)('0' + ms / 100);
+        *p++ = (char)('0' + ms / 10 % 10);
+        *p++ = (char)('0' + ms % 10);
+    }
+    *p++ = ']';
+    *p++ = ' ';
+    *p++ = '[';
+    if (colored) {
+        memcpy(p, level_colors[lv], 7);
+        p += 7;
+    }
+    memcpy(p, level_names[lv], 5);
+    p += 5;
+    if (colored) {
+        memcpy(p, "\033[0m", 4);
+        p += 4;
+    }
+    *p++ = ']';
+    *p++ = ' ';
+    if (text_offset != NULL) *text_offset = (int)(p - begin);
+    return (int)(p - begin);
 }
-void getLogLevelStr(enum LogLevel lv, char* buffer, int size) // 获取日志级别字符串
+
+// 同步模式: 整行格式化到线程私有缓冲区后一次 fwrite(标准输出流自带锁, 多线程输出的行不会交错)
+static void glog_sync(enum LogLevel lv, const char* format, va_list args)
 {
-    switch(lv) {
-        case LV_TRACE: strcpy(buffer, "\033[0;37mtrace\033[0m"); break;
-        case LV_DEBUG: strcpy(buffer, "\033[0;36mdebug\033[0m"); break;
-        case LV_INFO:  strcpy(buffer, "\033[0;32minfo \033[0m");  break;
-        case LV_WARN:  strcpy(buffer, "\033[0;33mwarn \033[0m");  break;
-        case LV_ERROR: strcpy(buffer, "\033[0;31merror\033[0m"); break;
-        case LV_FATAL: strcpy(buffer, "\033[0;35mfatal\033[0m"); break;
+    static __thread char line[GLOG_LINE_MAX];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int n = format_prefix(line, &ts, lv, 1, 0, NULL);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(line + n, sizeof(line) - n, format, copy);
+    va_end(copy);
+    if (len < 0) len = 0;
+    if ((size_t)(n + len) < sizeof(line)) {
+        fwrite(line, 1, n + len, stdout);
+        return;
     }
-    buffer[size - 1] = '\0';
+    char* heap = (char*)malloc(n + len + 1);    // 超长日志
+    if (heap == NULL) return;
+    memcpy(heap, line, n);
+    vsnprintf(heap + n, len + 1, format, args);
+    fwrite(heap, 1, n + len, stdout);
+    free(heap);
+}
+
+static int glog_ready(void)   // 队头槽位是否已发布
+{
+    uint64_t pos = __atomic_load_n(&g.dequeue_pos, __ATOMIC_RELAXED);
+    return __atomic_load_n(&g.slots[pos & g.mask].seq, __ATOMIC_ACQUIRE) == pos + 1;
+}
+
+static void glog_wake(void)
+{
+    pthread_mutex_lock(&g.mutex);
+    pthread_cond_signal(&g.cond);
+    pthread_mutex_unlock(&g.mutex);
+}
+
+// 异步模式: 整行格式化到线程私有缓冲区, 拷贝进队列槽位后发布; 队列满时让出 CPU 等待写线程
+// 调用方已计入 g.producers, glog_shutdown 等它们全部发布后才停止写线程, 因此写线程此时一定在运行
+static void glog_async(enum LogLevel lv, const char* format, va_list args)
+{
+    static __thread char line[GLOG_LINE_MAX];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int text_offset;
+    int n = format_prefix(line, &ts, lv, 0, 1, &text_offset);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(line + n, sizeof(line) - n - 1, format, copy);    // 留一个字节补换行
+    va_end(copy);
+    if (len < 0) len = 0;
+    char* text = line;
+    char* heap = NULL;
+    if ((size_t)(n + len) >= sizeof(line) - 1) {   // 超长日志格式化到堆上
+        heap = (char*)malloc(n + len + 2);
+        if (heap == NULL) return;
+        memcpy(heap, line, n);
+        vsnprintf(heap + n, len + 1, format, args);
+        text = heap;
+    }
+    size_t length = n + len;
+    if (len == 0 || text[length - 1] != '\n') text[length++] = '\n';   // 每条日志以换行结束
+    uint64_t pos = __atomic_load_n(&g.enqueue_pos, __ATOMIC_RELAXED);
+    struct glog_slot* slot;
+    for (;;) {
+        slot = &g.slots[pos & g.mask];
+        int64_t diff = (int64_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&g.enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {  // 队列满
+            sched_yield();
+            pos = __atomic_load_n(&g.enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&g.enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    if (length <= sizeof(slot->data)) {
+        memcpy(slot->data, text, length);
+        slot->heap = NULL;
+        free(heap);
+    } else {
+        if (heap == NULL) {
+            heap = (char*)malloc(length);
+            if (heap != NULL) memcpy(heap, text, length);
+            else length = 0;
+        }
+        slot->heap = heap;
+    }
+    slot->length = (uint32_t)length;
+    slot->text_offset = (uint16_t)text_offset;
+    slot->level = (uint8_t)lv;
+    slot->seconds = (int64_t)ts.tv_sec;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    // 写线程先置 parked 再复查队列, 生产者先发布再检查 parked, 两边各有一次全屏障, 不会丢失唤醒
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g.parked, __ATOMIC_RELAXED)) glog_wake();
 }
 
 void glog_format(enum LogLevel lv, const char *format, ...)
 {
-    static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
-    char datetime[22] = {0}, levelname[18] = {0};
-    getDateTime(datetime, sizeof(datetime));
-    getLogLevelStr(lv, levelname, sizeof(levelname));
-    // 每条日志确保完整性和顺序性
-    pthread_mutex_lock(&log_mutex);  // 加锁
-    glog("[%s] [%s] ", datetime, levelname);
+    if ((int)lv < __atomic_load_n(&g.level, __ATOMIC_RELAXED) || (int)lv < LV_TRACE || (int)lv > LV_FATAL) return;
     va_list args;
     va_start(args, format);
-    vprintf(format, args);
+    int async = 0;
+    if (__atomic_load_n(&g.async, __ATOMIC_ACQUIRE)) {
+        // 先登记再复查: 与 glog_shutdown 的"先清 async 再等 producers 归零"配对(均为全序), 停止后不会再有日志入队
+        __atomic_add_fetch(&g.producers, 1, __ATOMIC_SEQ_CST);
+        async = __atomic_load_n(&g.async, __ATOMIC_SEQ_CST);
+        if (async) glog_async(lv, format, args);
+        __atomic_sub_fetch(&g.producers, 1, __ATOMIC_RELEASE);
+    }
+    if (!async) glog_sync(lv, format, args);
     va_end(args);
-    pthread_mutex_unlock(&log_mutex);  // 解锁
+    if (lv >= LV_FATAL) glog_flush();
+}
+
+void glog_set_level(enum LogLevel lv)
+{
+    __atomic_store_n(&g.level, (int)lv, __ATOMIC_RELAXED);
+}
+
+static void write_all(int fd, const char* data, size_t length)
+{
+    while (length > 0 && fd >= 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;     // 写失败(磁盘满等)时丢弃本批, 不阻塞写线程
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+static void buffer_flush(struct glog_buffer* b)
+{
+    write_all(b->fd, b->data, b->used);
+    b->used = 0;
+}
+
+static void buffer_append(struct glog_buffer* b, const char* data, size_t length)
+{
+    if (b->used + length > sizeof(b->data)) buffer_flush(b);
+    if (length > sizeof(b->data)) {     // 超过缓冲区的行直接写出
+        write_all(b->fd, data, length);
+        return;
+    }
+    memcpy(b->data + b->used, data, length);
+    b->used += length;
+}
+
+static int make_dirs(const char* dir)   // 逐级创建日志目录
+{
+    char path[512];
+    size_t length = strlen(dir);
+    if (length == 0 || length >= sizeof(path)) return -1;
+    memcpy(path, dir, length + 1);
+    for (size_t i = 1; i <= length; ++i) {
+        if (path[i] != '/' && path[i] != '\0') continue;
+        char saved = path[i];
+        path[i] = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+        path[i] = saved;
+    }
+    return 0;
+}
+
+// 打开 seconds 所在日期的日志文件(追加写), 并计算下一个零点
+static int open_log_file(int64_t seconds)
+{
+    time_t t = (time_t)seconds;
+    struct tm tm_info;
+    localtime_r(&t, &tm_info);
+    char date[16];
+    strftime(date, sizeof(date), "%Y-%m-%d", &tm_info);
+    char path[768];
+    snprintf(path, sizeof(path), "%s/%s.%s.log", g.dir, g.module, date);
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    tm_info.tm_hour = 0;
+    tm_info.tm_min = 0;
+    tm_info.tm_sec = 0;
+    tm_info.tm_mday += 1;
+    tm_info.tm_isdst = -1;
+    g.next_midnight = (int64_t)mktime(&tm_info);
+    if (g.file->fd >= 0) close(g.file->fd);
+    g.file->fd = fd;
+    return fd >= 0 ? 0 : -1;
+}
+
+// 取出全部已发布的日志写入缓冲区, 一批结束后各调用一次 write; 返回取出条数
+static size_t glog_drain(void)
+{
+    size_t count = 0;
+    for (;;) {
+        uint64_t pos = g.dequeue_pos;
+        struct glog_slot* slot = &g.slots[pos & g.mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) break;
+        const char* text = slot->heap != NULL ? slot->heap : slot->data;
+        if (slot->seconds >= g.next_midnight) {     // 跨过零点: 写出上一天的日志后切换文件
+            buffer_flush(g.file);
+            open_log_file(slot->seconds);
+        }
+        buffer_append(g.file, text, slot->length);
+        if (g.to_stdout && slot->length >= slot->text_offset) {     // 终端输出带颜色
+            char prefix[64];
+            size_t head = slot->text_offset - 8;    // "[级别] " 之前的时间部分
+            memcpy(prefix, text, head);
+            char* p = prefix + head;
+            *p++ = '[';
+            memcpy(p, level_colors[slot->level], 7);
+            p += 7;
+            memcpy(p, level_names[slot->level], 5);
+            p += 5;
+            memcpy(p, "\033[0m] ", 6);
+            p += 6;
+            buffer_append(g.out, prefix, p - prefix);
+            buffer_append(g.out, text + slot->text_offset, slot->length - slot->text_offset);
+        }
+        free(slot->heap);
+        slot->heap = NULL;
+        __atomic_store_n(&slot->seq, pos + g.mask + 1, __ATOMIC_RELEASE);
+        g.dequeue_pos = pos + 1;
+        ++count;
+    }
+    if (count > 0) {
+        buffer_flush(g.file);
+        if (g.to_stdout) buffer_flush(g.out);
+        __atomic_store_n(&g.written_pos, g.dequeue_pos, __ATOMIC_RELEASE);
+    }
+    return count;
+}
+
+static void glog_park(void)    // 写线程休眠, 有日志发布、停止或超时后返回
+{
+    for (int i = 0; i < GLOG_WAIT_YIELD; ++i) {
+        if (glog_ready()) return;
+        sched_yield();
+    }
+    pthread_mutex_lock(&g.mutex);
+    __atomic_store_n(&g.parked, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!glog_ready() && __atomic_load_n(&g.running, __ATOMIC_RELAXED)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&g.cond, &g.mutex, &deadline);
+    }
+    __atomic_store_n(&g.parked, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g.mutex);
+}
+
+static void* glog_writer(void* arg)
+{
+    (void)arg;
+    while (__atomic_load_n(&g.running, __ATOMIC_ACQUIRE)) {
+        if (glog_drain() == 0) glog_park();
+    }
+    glog_drain();   // 停止后写出剩余日志(此时已没有调用方在入队)
+    return NULL;
+}
+
+int glog_init(const char *dir, const char *module, enum LogLevel level, int to_stdout)
+{
+    static int exit_hook_registered = 0;
+    if (__atomic_load_n(&g.async, __ATOMIC_ACQUIRE)) return 0;
+    if (g.slots == NULL) {
+        g.slots = (struct glog_slot*)calloc(GLOG_QUEUE_CAPACITY, sizeof(struct glog_slot));
+        g.file = (struct glog_buffer*)malloc(sizeof(struct glog_buffer));
+        g.out = (struct glog_buffer*)malloc(sizeof(struct glog_buffer));
+        if (g.slots == NULL || g.file == NULL || g.out == NULL) return -1;
+        g.mask = GLOG_QUEUE_CAPACITY - 1;
+        for (uint64_t i = 0; i < GLOG_QUEUE_CAPACITY; ++i) g.slots[i].seq = i;
+        g.file->fd = -1;
+        g.out->fd = STDOUT_FILENO;
+    }
+    g.file->used = 0;
+    g.out->used = 0;
+    snprintf(g.dir, sizeof(g.dir), "%s", dir != NULL && dir[0] != '\0' ? dir : "./logs");
+    snprintf(g.module, sizeof(g.module), "%s", module != NULL && module[0] != '\0' ? module : "default");
+    g.to_stdout = to_stdout;
+    if (make_dirs(g.dir) != 0 || open_log_file((int64_t)time(NULL)) != 0) {
+        fprintf(stderr, "glog_init: cannot create log file in %s: %s\n", g.dir, strerror(errno));
+        return -1;
+    }
+    glog_set_level(level);
+    __atomic_store_n(&g.written_pos, g.dequeue_pos, __ATOMIC_RELAXED);
+    fflush(stdout);     // 之前同步输出的内容先于写线程的输出
+    __atomic_store_n(&g.running, 1, __ATOMIC_RELAXED);
+    if (pthread_create(&g.thread, NULL, glog_writer, NULL) != 0) {
+        __atomic_store_n(&g.running, 0, __ATOMIC_RELAXED);
+        return -1;
+    }
+    __atomic_store_n(&g.async, 1, __ATOMIC_RELEASE);
+    if (!exit_hook_registered) {    // 进程正常退出时写出队列中剩余的日志
+        exit_hook_registered = 1;
+        atexit(glog_shutdown);
+    }
+    return 0;
+}
+
+void glog_shutdown(void)
+{
+    if (!__atomic_exchange_n(&g.async, 0, __ATOMIC_SEQ_CST)) return;
+    while (__atomic_load_n(&g.producers, __ATOMIC_SEQ_CST) != 0) sched_yield();   // 等已通过 async 检查的调用方发布完
+    __atomic_store_n(&g.running, 0, __ATOMIC_RELEASE);
+    glog_wake();
+    pthread_join(g.thread, NULL);
+    if (g.file->fd >= 0) close(g.file->fd);
+    g.file->fd = -1;
+}
+
+void glog_flush(void)
+{
+    uint64_t target = __atomic_load_n(&g.enqueue_pos, __ATOMIC_ACQUIRE);
+    while (__atomic_load_n(&g.async, __ATOMIC_ACQUIRE) && __atomic_load_n(&g.written_pos, __ATOMIC_ACQUIRE) < target) {
+        glog_wake();
+        struct timespec pause = { 0, 200000 };
+        nanosleep(&pause, NULL);
+    }
+    if (!__atomic_load_n(&g.async, __ATOMIC_ACQUIRE)) fflush(stdout);
 }
@@ -19,6 +19,18 @@ enum LogLevel {
 void glog(const char *format, ...) PRINTF_LIKE(1);
 void glog_format(enum LogLevel lv, const char *format, ...) PRINTF_LIKE(2);
 
+// 异步文件模式: glog_init 之后日志宏在调用线程中格式化为整行(线程私有缓冲区), 经无锁队列交给后台写线程,
+// 写线程每批合并为一次 write 写入 <dir>/<module>.<YYYY-MM-DD>.log, 跨过零点时切换到新日期的文件
+// 未调用 glog_init(或 glog_shutdown 之后)时日志同步输出到标准输出
+// 返回 0 成功, -1 失败(目录或文件无法创建、线程无法启动), 失败时保持同步输出
+int glog_init(const char *dir, const char *module, enum LogLevel level, int to_stdout);
+// 停止写线程: 写出队列中剩余的日志后关闭文件(进程正常退出时自动调用)
+void glog_shutdown(void);
+// 等待调用前已入队的日志全部写出(LV_FATAL 日志自动调用)
+void glog_flush(void);
+// 设置最低输出级别(两种模式都生效, 默认 LV_TRACE)
+void glog_set_level(enum LogLevel lv);
+
 inline static const char* my_basename(const char* path) {
     const char* base = strrchr(path, '/');
     return base ? base + 1 : path;
@@ -0,0 +1,28 @@
+#include <pthread.h>
+#include "glog.h"
+
+// 异步文件模式测试: 日志写入 ./logs/clog.<日期>.log, 同时输出到终端
+static void* worker(void* arg)
+{
+    long id = (long)arg;
+    for (int i = 0; i < 1000; ++i) {
+        LOG_INFO("worker %ld message %d\n", id, i);
+    }
+    return NULL;
+}
+
+int main()
+{
+    glog_init("./logs", "clog", LV_TRACE, 1);
+    LOG_TRACE("Trace message\n");
+    LOG_DEBUG("Debug message\n");
+    LOG_INFO("Info message\n");
+    LOG_WARN("Warn message\n");
+    LOG_ERROR("Error message\n");
+    pthread_t threads[4];
+    for (long i = 0; i < 4; ++i) pthread_create(&threads[i], NULL, worker, (void*)i);
+    for (int i = 0; i < 4; ++i) pthread_join(threads[i], NULL);
+    LOG_FATAL("Fatal message\n");
+    glog_shutdown();
+    return 0;
+}
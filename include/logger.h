@@ -6,11 +6,32 @@
 #include <cstdarg>
 #include <mutex>
 #include <map>
-#include <queue>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <climits>
+#include <cstdint>
 #include <thread>
 #include <fstream>
 #include <algorithm>
-#include <condition_variable>
+#include "logger_ring.h"
+#include "logger_args.h"
+#include "logger_time.h"
+#include "logger_writer.h"
+#include "logger_archive.h"
+#include "logger_stats.h"
+#include "logger_pool.h"
+#include "logger_fmt.h"
+#include "logger_binary.h"
+#include "logger_index.h"
+#include "logger_limit.h"
+#include "logger_wait.h"
+#include "logger_watch.h"
+#include "logger_config.h"
+#include "logger_shm.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
@@ -39,6 +60,18 @@ enum LogLevel {
     LV_CLOSE,  // 关闭日志
 };
 
+// 延迟格式化模式: 日志宏只记录调用点和参数原始字节, printf 格式化由后台日志线程完成
+// 例如 -DLOGGER_DEFERRED_FORMAT=1; 该模式下 %s 参数按内容拷贝, 参数只能是算术类型、枚举、指针和C字符串
+#ifndef LOGGER_DEFERRED_FORMAT
+#define LOGGER_DEFERRED_FORMAT 0
+#endif
+
+// 编译期最低日志级别, 低于该级别的 LOG_XXX 宏被完全编译掉(参数也不会求值)
+// 例如 -DLOGGER_COMPILE_MIN_LEVEL=2 将移除 LOG_TRACE/LOG_DEBUG
+#ifndef LOGGER_COMPILE_MIN_LEVEL
+#define LOGGER_COMPILE_MIN_LEVEL 0
+#endif
+
 // 日志级别名称
 const std::string LogLevelNames[] = {
 #if 0
@@ -72,28 +105,192 @@ const std::string LogLevelColors[] = {
 // 日志级别颜色重置
 const std::string LogLevelReset = "\033[0m";
 
-// 日志内容结构体
+// 队列槽位内联缓冲区大小: 日志内容(或延迟格式化参数)不超过该长度时直接写入槽位, 超出部分使用溢出块
+// 默认值使共享队列每个槽位正好占 256 字节(4 个缓存行)
+#ifndef LOG_MESSAGE_INLINE_SIZE
+#define LOG_MESSAGE_INLINE_SIZE 200
+#endif
+
+// 日志内容结构体(定长, 预分配在队列槽位中, 调用方不分配内存)
 struct LogMessage {
     LogLevel level;         // 日志级别
-    std::string time;       // 日志时间
-    std::string message;    // 日志内容
+    uint32_t length = 0;    // 内容长度(已格式化文本, 或延迟格式化时的参数原始字节)
+    uint8_t fileLevel = 0;  // 文件级别(调用点入队时确定, 按模块/源文件配置可能低于全局级别)
+    uint64_t timestamp;     // 日志时间(调用点采样的原始时钟值, 见 LogClock)
+    const LogCallSite* site = nullptr;      // 调用点(延迟格式化时有效)
+    const LogArgSchema* schema = nullptr;   // 参数描述(延迟格式化时有效, 为空表示内容已格式化)
+    LogSpillBlock* spill = nullptr;         // 溢出块(内容超出内联缓冲区时有效, 由日志线程归还)
+    char inlineData[LOG_MESSAGE_INLINE_SIZE];   // 内联缓冲区
+
+    inline const char* data() const { return spill != nullptr ? spill->data() : inlineData; }
 };
 
+// 正在写入队列的调用方线程数: 按线程分散到多个缓存行, 调用方只修改自己所在的计数, 避免共享计数成为热点
+// 调用方先登记再复查 running, shutdown 先清除 running 再等待全部归零(均为全序), 之后不会再有日志入队
+#ifndef LOG_PRODUCER_STRIPES
+#define LOG_PRODUCER_STRIPES 16
+#endif
+class LogProducerCount {
+public:
+    inline void enter() { stripes[stripeIndex()].count.fetch_add(1, std::memory_order_seq_cst); }
+    inline void leave() { stripes[stripeIndex()].count.fetch_sub(1, std::memory_order_release); }
+    inline bool idle() const {
+        for (int i = 0; i < LOG_PRODUCER_STRIPES; ++i) {
+            if (stripes[i].count.load(std::memory_order_seq_cst) != 0) return false;
+        }
+        return true;
+    }
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<int> count{0};
+    };
+    static inline int stripeIndex() {   // 每个线程固定使用一个计数
+        static std::atomic<int> next{0};
+        static thread_local int index = next.fetch_add(1, std::memory_order_relaxed) % LOG_PRODUCER_STRIPES;
+        return index;
+    }
+    Stripe stripes[LOG_PRODUCER_STRIPES];
+};
+
+// 线程私有队列(LOG_QUEUE_PER_THREAD 模式): 线程首次写日志时创建并登记到 Logger,
+// 线程退出时标记 retired, 由日志线程取空后回收
+struct LogThreadBuffer {
+    explicit LogThreadBuffer(size_t capacity) : ring(capacity) {}
+    LogSpscRing<LogMessage> ring;       // 单生产者队列
+    std::atomic<bool> retired{false};   // 所属线程已退出
+};
+// 线程私有状态本身不析构(线程退出期间一直有效), 由 LogThreadExit 在线程退出时调用 retire
+struct LogThreadBufferHolder {
+    LogThreadBuffer* buffer = nullptr;  // 当前线程的私有队列(由日志线程回收)
+    bool registered = false;            // 是否已尝试登记(登记表满时为空, 使用共享队列)
+    inline void retire() {  // 之后(其他 thread_local 析构中)的日志使用共享队列, 不再写入可能已被回收的队列
+        if (buffer != nullptr) buffer->retired.store(true, std::memory_order_release);
+        buffer = nullptr;
+        registered = true;
+    }
+};
+template <typename Holder>
+struct LogThreadExit {
+    Holder* holder = nullptr;
+    ~LogThreadExit() {
+        if (holder != nullptr) holder->retire();
+    }
+};
+// 飞行记录器: 每个线程一个定长环形缓冲区, 保存低于输出级别的日志(不入队、不写文件), 出现错误等时转储最近的内容
+// 所属线程是唯一写者, 槽位序号为 2*(位置+1) 表示写完、奇数表示写入中; 读取方拷贝后校验序号, 丢弃正在被覆盖的槽位
+struct LogFlightEntry {
+    std::atomic<uint64_t> seq{0};       // 槽位序号
+    LogMessage msg;                     // 日志(只用内联缓冲区, 不使用溢出块)
+};
+struct LogFlightRing {
+    explicit LogFlightRing(size_t capacity) : entries(capacity) {}
+    std::vector<LogFlightEntry> entries;
+    std::atomic<uint64_t> head{0};      // 已写入条数(所属线程递增)
+    uint64_t dumped = 0;                // 已转储到的位置(仅日志线程和崩溃转储使用)
+    std::atomic<bool> retired{false};   // 所属线程已退出
+    bool retiredSeen = false;           // 日志线程已看到退出标记, 下一轮回收
+};
+struct LogFlightHolder {
+    LogFlightRing* ring = nullptr;      // 当前线程的飞行记录器(由日志线程回收)
+    bool registered = false;            // 是否已尝试登记
+    inline void retire() {  // 之后(其他 thread_local 析构中)的日志不再进入飞行记录器
+        if (ring != nullptr) ring->retired.store(true, std::memory_order_release);
+        ring = nullptr;
+        registered = true;
+    }
+};
+// 归并堆元素: 各线程私有队列的队头时间戳
+struct LogMergeEntry {
+    uint64_t timestamp;     // 队头日志时间戳
+    size_t index;           // 登记表下标
+    size_t remaining;       // 本批剩余条数(只处理取批时已发布的日志, 避免持续写入时日志线程无法结束本批)
+    static inline bool later(const LogMergeEntry& a, const LogMergeEntry& b) {
+        return a.timestamp > b.timestamp;
+    }
+};
+
+inline static const char* my_basename(const char* path) {
+#if defined(_WIN32) || defined(_WIN64)
+    const char* base = strrchr(path, '\\');
+    return base? base+1 : path;
+#else
+    const char* base = strrchr(path, '/');
+    return base? base+1 : path;
+#endif
+}
+#define __FILENAME__ my_basename(__FILE__)
+
 #if defined(_WIN32) || defined(_WIN64)  
 #define LOG_SLEEP(n) Sleep(n);  // 单位为毫秒    
 #else 
 #define LOG_SLEEP(n) usleep(1000 * n);  // 单位为毫秒
 #endif
 
+// 日志队列默认容量(槽位数, 向上取整为2的幂), 可通过配置 queue_capacity 修改
+#ifndef LOG_QUEUE_CAPACITY
+#define LOG_QUEUE_CAPACITY 65536
+#endif
+
+// 线程私有队列默认容量(LOG_QUEUE_PER_THREAD 模式, 每个线程的槽位数), 可通过配置 thread_queue_capacity 修改
+#ifndef LOG_THREAD_QUEUE_CAPACITY
+#define LOG_THREAD_QUEUE_CAPACITY 4096
+#endif
+// 最多登记的线程私有队列数, 超出的线程退回共享队列
+#ifndef LOG_MAX_THREAD_BUFFERS
+#define LOG_MAX_THREAD_BUFFERS 1024
+#endif
+
+// 日志队列模式
+enum LogQueueMode {
+    LOG_QUEUE_SHARED,       // 所有线程共享一个无锁多生产者队列(默认)
+    LOG_QUEUE_PER_THREAD,   // 每个线程一个单生产者队列, 日志线程按时间戳归并
+};
+
+// 日志文件格式
+enum LogFileFormat {
+    LOG_FORMAT_TEXT,        // 文本(.log), 默认
+    LOG_FORMAT_BINARY,      // 二进制(.blog, 见 logger_binary.h), 用 logcat 解码
+};
+
+// 日志队列满时的处理策略
+enum LogOverflowPolicy {
+    LOG_OVERFLOW_BLOCK,             // 阻塞调用方直到有空位(默认)
+    LOG_OVERFLOW_DROP_NEWEST,       // 丢弃当前(最新)日志
+    LOG_OVERFLOW_DROP_OLDEST,       // 丢弃队列中最旧的日志
+    LOG_OVERFLOW_DROP_BELOW_LEVEL,  // 低于 overflow_level 的日志丢弃, 其余阻塞
+};
+
+// 日志流水线统计快照(Logger::stats)
+struct LogStats {
+    uint64_t enqueued[LV_CLOSE + 1];    // 各级别已入队并被取出的日志数(不含仍在队列中的 queueDepth 条)
+    uint64_t written[LV_CLOSE + 1];     // 各级别已写入输出端(文件或终端)的日志数
+    uint64_t dropped[LV_CLOSE + 1];     // 各级别因队列满被丢弃的日志数
+    size_t queueDepth;                  // 当前队列深度
+    size_t queueHighWater;              // 队列深度峰值(日志线程每批开始时采样)
+    size_t queueCapacity;               // 共享队列容量
+    size_t threadQueues;                // 已登记的线程私有队列数
+    LogWriterStats writer;              // 日志文件写入统计(字节数、系统调用次数等)
+    LogHistogramSnapshot latency;       // 入队到写入缓冲区的延迟(纳秒)
+    LogHistogramSnapshot writeLatency;  // 日志文件 write 系统调用耗时(纳秒)
+    uint64_t consumerParks;             // 日志线程空闲休眠次数
+};
+
 class Logger {
 private:
-    bool running;           // 是否运行
-    bool outputToTerminal;  // 是否输出到终端
-    LogLevel logLevel;      // 日志级别
+    std::atomic<bool> running{false};   // 是否运行
+    std::atomic<bool> outputToTerminal; // 是否输出到终端
+    std::atomic<int> logLevel;          // 日志文件级别
+    std::atomic<int> consoleLevel;      // 终端输出级别
+    std::atomic<int> outputLevel;       // 文件和终端输出中的最低级别, 低于该级别的日志只进入飞行记录器
+    std::atomic<int> enabledLevel;      // 调用方判断用的最低级别(含飞行记录器, 调用方线程无锁读取)
+    std::atomic<int> consoleColor{-1};  // 终端颜色: -1 自动(仅终端时启用), 0 关闭, 1 开启
     std::string logDir;     // 日志目录
     std::string logModuleName;  // 日志模块名称
     std::string logFileName;    // 日志文件名
     std::string logCreateDate;  // 日志创建日期
+    int64_t nextRotateNanos = 0;    // 下一个零点(纪元纳秒), 到达后切换日志文件
+    std::atomic<int> timePrecision{LOG_TIME_MS};    // 时间戳精度
     std::string logConfigFile;  // 日志配置文件
 
 public:
@@ -104,12 +301,16 @@ public:
     Logger(std::string logDir, std::string logModuleName, LogLevel logLevel, bool outputToTerminal) {
         this->logDir = logDir;
         this->logModuleName = logModuleName;
-        this->logLevel = logLevel;
-        this->outputToTerminal = outputToTerminal;
+        this->logLevel.store(logLevel, std::memory_order_relaxed);
+        this->consoleLevel.store(logLevel, std::memory_order_relaxed);
+        this->outputToTerminal.store(outputToTerminal, std::memory_order_relaxed);
+        updateEnabledLevel();
         logConfigFile = "./logger.conf";   // 日志配置文件名称
+        logQueue.reset(new LogRingBuffer<LogMessage>(LOG_QUEUE_CAPACITY));
+        queueCapacity = logQueue->capacity();
     }
     ~Logger() {
-        running = false; 
+        shutdown();
     }
     inline static Logger* getInstance(std::string logDir = "./logs", std::string logModuleName = "default", LogLevel logLevel = LogLevel::LV_INFO, bool outputToTerminal = true) // 获取单例对象
     {
@@ -118,51 +319,469 @@ public:
         }
         return instance;
     }
+    inline static Logger* logInstance()     // 日志宏获取单例对象: 已创建时只读一次指针, 未创建时(慢路径)与 getInstance() 一样按默认参数创建
+    {
+        Logger* logger = instance;
+        return logger != nullptr ? logger : getInstance();
+    }
+    inline bool isEnabled(LogLevel level) const  // 判断该级别日志是否需要输出(一次原子读取)
+    {
+        return level >= enabledLevel.load(std::memory_order_relaxed) && running.load(std::memory_order_relaxed);
+    }
+    // 按调用点级别缓存判断(日志宏使用): 已解析时只有一次原子读取, levels 返回打包的级别供写入时使用
+    inline bool isEnabled(LogLevel level, LogSiteLevel& site, const LogModule* module, int& levels)
+    {
+        levels = site.levels.load(std::memory_order_relaxed);
+        if (level < logSiteEnabled(levels)) return false;
+        if ((levels & LOG_SITE_RESOLVED) == 0) levels = resolveSite(site, module);
+        return level >= logSiteEnabled(levels);
+    }
+    inline bool isEnabled(LogLevel level, LogModule& module)  // 判断命名日志器的该级别日志是否需要输出
+    {
+        int levels;
+        return isEnabled(level, module.levelCache(), &module, levels);
+    }
+    // 取得命名日志器(不存在时创建, 进程内不销毁); 级别由配置 level.<name>=N 或 setModuleLevel 设置, 未设置时使用 log_level
+    inline LogModule& getModule(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(siteMtx);
+        std::unique_ptr<LogModule>& module = modules[name];
+        if (!module) module.reset(new LogModule(name));
+        return *module;
+    }
+    // 设置模块/源文件(不含目录)的文件级别, level 小于 0 表示取消; 配置文件重新加载时以配置文件为准
+    inline void setModuleLevel(const std::string& name, int level)
+    {
+        updateConfig([&](LogConfigSnapshot& snapshot) {
+            if (level < 0) snapshot.moduleLevels.erase(name);
+            else snapshot.moduleLevels[name] = level;
+        });
+    }
+    inline void setFileLevel(const std::string& file, int level)
+    {
+        updateConfig([&](LogConfigSnapshot& snapshot) {
+            if (level < 0) snapshot.fileLevels.erase(file);
+            else snapshot.fileLevels[file] = level;
+        });
+    }
+    inline std::shared_ptr<const LogConfigSnapshot> configSnapshot() const  // 当前配置快照(只读)
+    {
+        return std::atomic_load(&config);
+    }
+    inline void setLogLevel(LogLevel level)  // 设置日志级别
+    {
+        logLevel.store(level, std::memory_order_relaxed);
+        updateEnabledLevel();
+    }
+    inline void setConsoleLevel(LogLevel level)  // 设置终端输出级别(与日志文件级别独立)
+    {
+        consoleLevel.store(level, std::memory_order_relaxed);
+        updateEnabledLevel();
+    }
+    inline void setOutputToTerminal(bool enable)  // 设置是否输出到终端
+    {
+        outputToTerminal.store(enable, std::memory_order_relaxed);
+        updateEnabledLevel();
+    }
+    // 设置飞行记录器: 每个线程保留最近 entries 条低于输出级别、不低于 level 的日志(0 表示关闭)
+    // 容量对之后首次写日志的线程生效; 延迟格式化的日志只拷贝参数, 不格式化
+    inline void setFlightRecorder(size_t entries, LogLevel level = LV_TRACE)
+    {
+        flightCapacity.store(entries, std::memory_order_relaxed);
+        flightLevel.store(level, std::memory_order_relaxed);
+        updateEnabledLevel();
+    }
+    inline void setFlightDumpLevel(LogLevel level)  // 设置触发飞行记录器转储的级别(默认 ERROR)
+    {
+        flightDumpLevel.store(level, std::memory_order_relaxed);
+    }
+    inline void dumpFlightRecorder()  // 把各线程飞行记录器中尚未转储的日志写入日志文件(等待写出后返回)
+    {
+        flightDumpRequested.store(true, std::memory_order_release);
+        flush();
+    }
+    inline void installFlightSignal()  // 收到 SIGUSR1 时转储飞行记录器(信号处理函数只设置标记, 由日志线程转储)
+    {
+#if !defined(_WIN32) && !defined(_WIN64)
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = flightSignalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &action, nullptr);
+#endif
+    }
+    inline void setConsoleColor(int mode)  // 设置终端颜色: -1 自动, 0 关闭, 1 开启
+    {
+        consoleColor.store(mode, std::memory_order_relaxed);
+    }
+    inline LogLevel getLogLevel() const  // 获取日志级别
+    {
+        return static_cast<LogLevel>(logLevel.load(std::memory_order_relaxed));
+    }
+    inline void setTimePrecision(LogTimePrecision precision)  // 设置时间戳精度
+    {
+        timePrecision.store(precision, std::memory_order_relaxed);
+    }
+    inline void setFlushPolicy(const LogFlushPolicy& policy)  // 设置刷盘策略(由日志线程在下一批次生效)
+    {
+        std::lock_guard<std::mutex> lock(configMtx);
+        flushPolicy = policy;
+        writerConfigChanged.store(true, std::memory_order_release);
+        waiter.wake();
+    }
+    inline void setRotationPolicy(const LogRotationPolicy& policy)  // 设置按大小切换、保留和压缩策略
+    {
+        std::lock_guard<std::mutex> lock(configMtx);
+        rotationPolicy = policy;
+        writerConfigChanged.store(true, std::memory_order_release);
+        waiter.wake();
+    }
+    inline void setFileSink(LogFileSink sink)  // 设置日志文件输出方式(write/mmap), 日志线程重新打开当前文件后生效
+    {
+        std::lock_guard<std::mutex> lock(configMtx);
+        fileSink = sink;
+        writerConfigChanged.store(true, std::memory_order_release);
+        waiter.wake();
+    }
+    inline void setFileFormat(LogFileFormat format)  // 设置日志文件格式(文本/二进制), 日志线程切换到对应扩展名的文件后生效
+    {
+        std::lock_guard<std::mutex> lock(configMtx);
+        fileFormat = format;
+        writerConfigChanged.store(true, std::memory_order_release);
+        waiter.wake();
+    }
+    inline void setStreamCompression(bool on)  // 设置流式压缩(写入 .log.gz/.blog.gz, 需要 zlib), 日志线程切换到对应扩展名的文件后生效
+    {
+        std::lock_guard<std::mutex> lock(configMtx);
+        streamCompress = on;
+        writerConfigChanged.store(true, std::memory_order_release);
+        waiter.wake();
+    }
+    inline void setIndexInterval(uint64_t bytes)  // 设置索引块大小(每写约 bytes 字节记录一个索引项, 0 表示不生成 .idx 索引文件)
+    {
+        std::lock_guard<std::mutex> lock(configMtx);
+        indexInterval = bytes;
+        writerConfigChanged.store(true, std::memory_order_release);
+        waiter.wake();
+    }
+    inline void setConsumerWait(LogWaitMode mode)  // 设置日志线程空闲时的等待方式(自适应/固定轮询)
+    {
+        waitMode.store(mode, std::memory_order_relaxed);
+        waiter.wake();
+    }
+    inline void setTransport(LogTransport mode, size_t shmBytes = LOG_SHM_SIZE)  // 设置日志输出方式(本进程日志文件/共享内存由 logd 采集), 需在 start 之前调用
+    {
+        transport = mode;
+        shmSize = shmBytes;
+    }
+    inline LogTransport getTransport() const  // 当前实际使用的输出方式(共享内存创建失败时为本进程日志文件)
+    {
+        return shmRing.isOpen() ? LOG_TRANSPORT_SHM : LOG_TRANSPORT_FILE;
+    }
+    inline void setConfigFile(const std::string& path)  // 设置日志配置文件(默认 ./logger.conf), 需在 start 之前调用
+    {
+        logConfigFile = path;
+    }
+    inline LogWriterStats writerStats()  // 获取文件写入统计(系统调用次数、平均批大小)
+    {
+        return fileWriter.stats();
+    }
+    inline void setQueueCapacity(size_t capacity)  // 设置日志队列容量(需在 start 之前调用)
+    {
+        queueCapacity = capacity;
+    }
+    inline void setQueueMode(LogQueueMode mode)  // 设置队列模式(可在运行中切换, 日志线程同时处理两种队列)
+    {
+        queueMode.store(mode, std::memory_order_relaxed);
+    }
+    inline void setThreadQueueCapacity(size_t capacity)  // 设置线程私有队列容量(对之后登记的线程生效)
+    {
+        threadQueueCapacity.store(capacity, std::memory_order_relaxed);
+    }
+    inline void setOverflowPolicy(LogOverflowPolicy policy, LogLevel level = LV_WARN)  // 设置队列满时的处理策略
+    {
+        overflowPolicy.store(policy, std::memory_order_relaxed);
+        overflowLevel.store(level, std::memory_order_relaxed);
+    }
+    inline uint64_t droppedCount(LogLevel level) const  // 获取该级别因队列满被丢弃的日志数
+    {
+        return level < LV_CLOSE + 1 ? dropped[level].load(std::memory_order_relaxed) : 0;
+    }
+    inline uint64_t droppedCount() const  // 获取因队列满被丢弃的日志总数
+    {
+        uint64_t total = 0;
+        for (int i = 0; i <= LV_CLOSE; ++i) total += dropped[i].load(std::memory_order_relaxed);
+        return total;
+    }
+    inline void setStatsInterval(int ms)  // 设置统计信息写入日志的周期(毫秒), 0 表示不写
+    {
+        statsIntervalMs.store(ms, std::memory_order_relaxed);
+    }
+    inline LogStats stats()  // 获取日志流水线统计快照(计数器均为 relaxed 原子量, 各项之间不保证严格一致)
+    {
+        LogStats s;
+        for (int i = 0; i <= LV_CLOSE; ++i) {
+            s.enqueued[i] = enqueued[i].load(std::memory_order_relaxed);
+            s.written[i] = written[i].load(std::memory_order_relaxed);
+            s.dropped[i] = dropped[i].load(std::memory_order_relaxed);
+        }
+        s.queueDepth = logQueue->size() + threadQueueDepth.load(std::memory_order_relaxed);
+        s.queueHighWater = std::max(queueHighWater.load(std::memory_order_relaxed), s.queueDepth);
+        s.queueCapacity = logQueue->capacity();
+        s.threadQueues = threadQueueCount.load(std::memory_order_relaxed);
+        s.writer = fileWriter.stats();
+        s.latency = enqueueLatency.snapshot();
+        s.writeLatency = fileWriter.syscallLatency();
+        s.consumerParks = waiter.parkCount();
+        return s;
+    }
     inline void start() 
     {
+        if (running) return;
+        if (checkConfigFileChange()) loadConfig();  // 启动前先加载配置(队列容量等)
+        if (queueCapacity != logQueue->capacity()) {
+            logQueue.reset(new LogRingBuffer<LogMessage>(queueCapacity));
+        }
+        flushedPos.store(logQueue->dequeuePosition(), std::memory_order_relaxed);
+        flushedRequest.store(flushRequests.load(std::memory_order_relaxed), std::memory_order_relaxed);
         running = true;
-        logCreateDate = getDate();  // 获取当前日期
-        createLogDir();     // 创建日志目录
-        createLogFile();    // 创建日志文件
+        refreshSites();     // 已登记的调用点从关闭状态恢复
+        static bool exitHookRegistered = false;
+        if (!exitHookRegistered) {  // 进程正常退出时写出队列中剩余的日志
+            exitHookRegistered = true;
+            std::atexit(shutdownAtExit);
+        }
+        LogClock::calibrate();  // 校准时钟
+        if (transport == LOG_TRANSPORT_SHM && !shmRing.open(logModuleName, shmSize)) {
+            std::cerr << "Failed to create shared memory log ring, writing log file instead" << std::endl;
+        }
+        applyWriterConfig();
+        archiver.start();   // 启动归档线程
+        if (!shmRing.isOpen()) {    // 共享内存传输时由 logd 写文件, 本进程不创建日志文件
+            createLogDir();     // 创建日志目录
+            createLogFile();    // 创建日志文件
+            archiver.submit(logDir, logModuleName, std::string(), logFileName, rotation);  // 按保留策略清理历史文件
+        }
+        consoleWriter.attachStdout();   // 终端输出同样由日志线程批量写入
+        consoleIsTerminal = consoleWriter.isTerminal();
+        configWatcher.open(logConfigFile);  // 在启动线程前打开, shutdown 一定能唤醒监视线程
         // 启动日志处理线程
         logThread = std::thread([this]() {
             // std::cout << "日志处理线程启动" << std::endl;
             while(running) {
-                while(!logQueue.empty())  {
-                    std::unique_lock<std::mutex> lock(logQueueMtx);  // 加锁
-                    cv.wait(lock, [this]() { return !logQueue.empty() || !running; });
-                    if (!running) break;
-                    auto& msg = logQueue.front();
-                    if(msg.level >= logLevel) writeLog(msg.level, msg.time, msg.message); // 写入日志
-                    logQueue.pop();
-                }
-                LOG_SLEEP(10); // 等待10毫秒
+                if (crashing.load(std::memory_order_acquire)) parkForCrash();
+                uint64_t requests = flushRequests.load(std::memory_order_acquire);   // 本批之前的 flush 请求
+                drainQueue();
+                reportDropped();
+                reportStats();
+                applyWriterConfig();
+                serveFlightDump();
+                fileWriter.onBatchEnd();    // 一批日志合并为一次写入
+                consoleWriter.onBatchEnd();
+                serveFlush(requests);
+                waitForWork();
             }
             // std::cout << "日志处理线程结束" << std::endl;
         });
-        // 启动定时器线程,定时读取日志配置文件
+        // 启动配置监视线程: inotify 通知配置文件变化时立即重新加载, 不可用时每5秒检查一次修改时间
         timerThread = std::thread([this]() {
             // std::cout << "定时器线程启动" << std::endl;
+            while (running && configWatcher.isOpen() && configWatcher.wait()) {
+                this->checkConfigFileChange();  // 更新记录的修改时间(同一秒内的多次修改也重新加载)
+                this->loadConfig();
+            }
             while(running) {
                 if (this->checkConfigFileChange()) {
                     this->loadConfig();
                 }
-                std::this_thread::sleep_for(std::chrono::seconds(5));
+                for (int i = 0; i < 500 && running; ++i) LOG_SLEEP(10);   // 每5秒检查一次, 退出时及时响应
             }
             // std::cout << "定时器线程结束" << std::endl;
         });
         LOG_SLEEP(100); // 等待日志处理线程启动
     }
+    // 停止日志: 等待后台线程退出, 取空队列并写出全部日志后关闭文件(可重复调用, 析构和进程退出时自动调用)
+    inline void shutdown()
+    {
+        running = false;
+        refreshSites();
+        waiter.wake();
+        while (!producers.idle()) std::this_thread::yield();   // 等已通过 running 检查的调用方发布完(日志线程仍在取队列)
+        configWatcher.interrupt();
+        if (logThread.joinable()) logThread.join();
+        if (timerThread.joinable()) timerThread.join();
+        configWatcher.close();
+        drainQueue();   // 后台线程已退出, 由当前线程处理剩余日志
+        reportDropped();
+        shmRing.close();    // 已写入共享内存的日志留给 logd 取出
+        closeLogFile();
+        consoleWriter.flush();
+        {
+            std::lock_guard<std::mutex> lock(flushMtx);
+            flushedPos.store(logQueue->dequeuePosition(), std::memory_order_release);
+            flushedRequest.store(flushRequests.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        flushCv.notify_all();
+        archiver.stop();
+    }
+    // 等待调用前已入队的日志全部写入文件和终端(write 返回), 不需要逐条刷盘
+    // 日志线程在取批之前读取请求计数, 写完该批后应答; 共享队列还需等待取出位置越过调用时的写游标
+    inline void flush()
+    {
+        if (!logThread.joinable() || std::this_thread::get_id() == logThread.get_id()) return;
+        size_t target = logQueue->enqueuePosition();
+        std::unique_lock<std::mutex> lock(flushMtx);
+        while (running) {
+            uint64_t request = flushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+            waiter.wake();
+            bool done = flushCv.wait_for(lock, std::chrono::milliseconds(10), [&]() {
+                return !running || (flushedRequest.load(std::memory_order_acquire) >= request &&
+                                    flushedPos.load(std::memory_order_acquire) >= target);
+            });
+            if (done) break;
+        }
+    }
+    // 安装崩溃处理(SIGSEGV/SIGABRT/SIGFPE/SIGILL/SIGBUS): 把写缓冲区和队列中未处理的日志直接写入日志文件,
+    // 之后恢复默认处理并重新触发信号; 同时 LOG_FATAL 会同步等待日志写出
+    inline void installCrashHandler()
+    {
+        crashHandlerEnabled.store(true, std::memory_order_relaxed);
+        const int signals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+#if !defined(_WIN32) && !defined(_WIN64)
+            SIGBUS,
+#endif
+        };
+        for (int sig : signals) {
+#if defined(_WIN32) || defined(_WIN64)
+            std::signal(sig, crashSignalHandler);
+#else
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = crashSignalHandler;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESETHAND;     // 处理一次后恢复默认行为
+            sigaction(sig, &action, nullptr);
+#endif
+        }
+    }
 
 public:
     inline void log(LogLevel level, const char* fmt, ...) 
     {
-        if(!running) return;
+        if(!isEnabled(level)) return;
+        va_list args;
+        va_start(args, fmt);
+        vlogAt(globalSiteLevels(), level, fmt, args);
+        va_end(args);
+    }
+    inline void logAt(int levels, LogLevel level, const char* fmt, ...)  // 日志宏使用: levels 为调用点已判断过的级别缓存
+    {
         va_list args;
         va_start(args, fmt);
-        std::string message = format(fmt, args);
+        vlogAt(levels, level, fmt, args);
         va_end(args);
-        addLogQueue(level, message);
+    }
+    inline void vlogAt(int levels, LogLevel level, const char* fmt, va_list args)
+    {
+        if (level < logSiteOutput(levels)) {  // 只进入飞行记录器(即时格式化方式下仍在调用线程 vsnprintf, 延迟格式化方式只拷贝参数)
+            LogMessage* slot = flightSlot(level);
+            if (slot != nullptr) {
+                int size = std::vsnprintf(slot->inlineData, LOG_MESSAGE_INLINE_SIZE, fmt, args);   // 超长时截断
+                slot->length = static_cast<uint32_t>(std::max(0, std::min(size, LOG_MESSAGE_INLINE_SIZE - 1)));
+                flightCommit();
+            }
+            return;
+        }
+        addLogQueue(level, logSiteFile(levels), fmt, args);  // 直接格式化到队列槽位
+        if (level >= LV_FATAL && crashHandlerEnabled.load(std::memory_order_relaxed)) flush();
+    }
+    // 延迟格式化日志: 只拷贝参数原始字节到队列槽位, 由日志线程格式化
+    template <typename... Args>
+    inline void logDeferred(LogLevel level, const LogCallSite* site, const Args&... args)
+    {
+        if(!isEnabled(level)) return;
+        logDeferredAt(globalSiteLevels(), level, site, args...);
+    }
+    template <typename... Args>
+    inline void logDeferredAt(int levels, LogLevel level, const LogCallSite* site, const Args&... args)
+    {
+        typedef LogArgEncoder<LogArgDecay<Args>...> Encoder;
+        if (level < logSiteOutput(levels)) {  // 只进入飞行记录器, 拷贝参数原始字节
+            LogMessage* slot = flightSlot(level);
+            if (slot == nullptr) return;
+            size_t size = Encoder::size(args...);
+            slot->site = site;
+            if (size <= LOG_MESSAGE_INLINE_SIZE) {
+                slot->schema = &LogArgPack<LogArgDecay<Args>...>::schema;
+                Encoder::encode(slot->inlineData, args...);
+                slot->length = static_cast<uint32_t>(size);
+            } else {    // 参数超出内联缓冲区: 只保存格式串
+                slot->length = static_cast<uint32_t>(logFlightText(slot->inlineData, site->fmt));
+            }
+            flightCommit();
+            return;
+        }
+        size_t pos;
+        LogThreadBuffer* local;
+        LogMessage* slot = acquireSlot(pos, level, local);
+        if (slot == nullptr) return;    // 队列满, 按策略丢弃
+        slot->level = level;
+        slot->fileLevel = static_cast<uint8_t>(logSiteFile(levels));
+        slot->timestamp = LogClock::raw();  // 取得槽位后再采样, 队列满等待时不会产生过旧的时间戳
+        slot->site = site;
+        slot->schema = &LogArgPack<LogArgDecay<Args>...>::schema;
+        size_t size = Encoder::size(args...);
+        Encoder::encode(reserveData(*slot, size), args...);
+        slot->length = static_cast<uint32_t>(size);
+        publishSlot(pos, local);
+        if (level >= LV_FATAL && crashHandlerEnabled.load(std::memory_order_relaxed)) flush();
+    }
+    // {} 格式化日志: 按参数类型直接写入队列槽位(见 logger_fmt.h), 预留长度取输出上界, 只格式化一遍
+    template <typename... Args>
+    inline void logFormat(LogLevel level, const char* file, int line, const char* fmt, const Args&... args)
+    {
+        if(!isEnabled(level)) return;
+        logFormatAt(globalSiteLevels(), level, file, line, fmt, args...);
+    }
+    template <typename... Args>
+    inline void logFormatAt(int levels, LogLevel level, const char* file, int line, const char* fmt, const Args&... args)
+    {
+        size_t fileLength = std::strlen(file);
+        size_t bound = fileLength + 16 + LogFmt::bound(fmt, args...);
+        bool flight = level < logSiteOutput(levels);     // 只进入飞行记录器
+        if (flight && bound > LOG_MESSAGE_INLINE_SIZE) {    // 超出内联缓冲区: 只保存格式串
+            LogMessage* slot = flightSlot(level);
+            if (slot == nullptr) return;
+            slot->length = static_cast<uint32_t>(logFlightText(slot->inlineData, fmt));
+            flightCommit();
+            return;
+        }
+        size_t pos;
+        LogThreadBuffer* local;
+        LogMessage* slot = flight ? flightSlot(level) : acquireSlot(pos, level, local);
+        if (slot == nullptr) return;    // 队列满, 按策略丢弃
+        slot->level = level;
+        slot->fileLevel = static_cast<uint8_t>(logSiteFile(levels));
+        slot->timestamp = LogClock::raw();  // 取得槽位后再采样, 队列满等待时不会产生过旧的时间戳
+        slot->schema = nullptr;
+        char* begin = flight ? slot->inlineData : reserveData(*slot, bound);
+        char* p = begin;
+        *p++ = '[';     // 与 printf 风格宏相同的 "[文件:行号] " 前缀
+        std::memcpy(p, file, fileLength);
+        p += fileLength;
+        *p++ = ':';
+        p = logFmtSigned(p, line);
+        *p++ = ']';
+        *p++ = ' ';
+        p = LogFmt::write(p, fmt, args...);
+        slot->length = static_cast<uint32_t>(p - begin);
+        if (flight) {
+            flightCommit();
+            return;
+        }
+        publishSlot(pos, local);
+        if (level >= LV_FATAL && crashHandlerEnabled.load(std::memory_order_relaxed)) flush();
     }
     inline void createLogDir()  // 创建日志目录 
     {
@@ -208,95 +827,975 @@ public:
         }
 #endif
     }
-    inline void createLogFile()  // 创建日志文件
+    inline void createLogFile()  // 创建日志文件(启动或跨天时调用)
     {
-#if defined(_WIN32) || defined(_WIN64)
-        logFileName = getCurrentLogFileName();
-        // 创建并打开日志文件
-        logFileHandle = CreateFile(logFileName.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-        if (logFileHandle == INVALID_HANDLE_VALUE) {
-            std::cerr << "Failed to create log file: " << logFileName << std::endl;
-            return;
+        std::string previous = fileWriter.isOpen() ? logFileName : std::string();
+        closeLogFile();     // 关闭上一个日志文件
+        int64_t now = LogClock::nowNanos();
+        logCreateDate = LogTimeFormatter::date(now);
+        nextRotateNanos = LogTimeFormatter::nextMidnight(now);  // 预先计算下一个零点
+        logFileIndex = 0;
+        openLogFile(previous);
+    }
+    inline void rotateLogFile()  // 日志文件达到大小上限, 切换到下一个序号的文件
+    {
+        std::string previous = logFileName;
+        closeLogFile();
+        ++logFileIndex;
+        openLogFile(previous);
+    }
+    inline void openLogFile(const std::string& previous)  // 打开当前序号的日志文件, 并把上一个文件交给归档线程
+    {
+        // 跳过已写满或已压缩的序号(例如同一天内重启)
+        while (rotation.maxFileSize > 0) {
+            logFileName = getCurrentLogFileName();
+            LogFileWriter::repairFile(logFileName);
+            int64_t size = LogArchiver::fileSize(logFileName);
+            if (size < static_cast<int64_t>(rotation.maxFileSize) && LogArchiver::fileSize(logFileName + ".gz") < 0) break;
+            ++logFileIndex;
         }
-        // 设置文件指针到文件末尾
-        SetFilePointer(logFileHandle, 0, NULL, FILE_END);
-#else
         logFileName = getCurrentLogFileName();
-        // 创建并打开日志文件
-        logfp.open(logFileName, std::ios::app);
-        if (!logfp.is_open()) {
+        LogFileWriter::repairFile(logFileName);     // mmap 方式异常退出后按 .len 记录截掉预先扩展的部分
+        // 创建并打开日志文件(追加写)
+        if (!fileWriter.open(logFileName)) {
             std::cerr << "Failed to create log file: " << logFileName << std::endl;
+        } else {
+            openIndexFile();
+            if (binaryFile) {   // 二进制文件每次打开写入文件头, 重置调用点字典
+                if (indexWriter.isOpen()) indexWriter.startBlock(fileWriter.currentSize());
+                writeBinaryHeader();
+            }
+        }
+        if (!previous.empty()) {
+            archiver.submit(logDir, logModuleName, previous, logFileName, rotation);
         }
-#endif
     }
     inline void closeLogFile()  // 关闭日志文件
     {
-#if defined(_WIN32) || defined(_WIN64)
-        if (logFileHandle != INVALID_HANDLE_VALUE) {
-            FlushFileBuffers(logFileHandle);
-            CloseHandle(logFileHandle);
-            std::cout << L"closeLogFile: " << logFileName << std::endl;
-        }
-#else
-        if (logfp.is_open()) {
-            logfp.flush();
-            logfp.close();
+        indexWriter.close(fileWriter.currentSize());    // 写出最后一个索引块
+        if (fileWriter.isOpen()) {
+            fileWriter.close();     // 写出缓冲区中剩余日志后关闭
             std::cout << "closeLogFile: " << logFileName << std::endl;
         }
-#endif
     }
-    inline void needCreateNewLogFile()  // 判断是否需要创建新的日志文件
+    inline void openIndexFile()  // 打开当前日志文件的索引文件(<日志文件>.idx)
+    {
+        if (indexBlockSize == 0 || compressedFile) return;    // 流式压缩文件由写入器按帧生成索引
+        if (!indexWriter.open(logFileName + ".idx", indexBlockSize)) {
+            std::cerr << "Failed to open log index file: " << logFileName << ".idx" << std::endl;
+        }
+    }
+    inline void writeBinaryHeader()  // 写入二进制文件头记录(重置调用点字典和时间基准)
+    {
+        char* begin = fileWriter.reserve(binaryEncoder.headerBound(logModuleName));
+        char* p = binaryEncoder.header(begin, LogClock::nowNanos(), logModuleName);
+        fileWriter.commit(p - begin, LV_TRACE);
+    }
+    // 写入一条记录前检查是否开始新的索引块或压缩帧, 二进制格式的新块/新帧以文件头开始以便单独解码
+    // bound 为记录的最大长度: 文件头和记录放不进当前帧时先结束当前帧, 保证两者在同一帧中
+    inline void indexRecord(int64_t nanos, int level, size_t bound)
+    {
+        if (binaryFile) {
+            fileWriter.prepare(binaryEncoder.headerBound(logModuleName) + bound);
+            if (fileWriter.frameBoundary()) writeBinaryHeader();
+        }
+        if (!indexWriter.isOpen()) return;
+        if (indexWriter.blockFull(fileWriter.currentSize())) {
+            indexWriter.startBlock(fileWriter.currentSize());
+            if (binaryFile) writeBinaryHeader();
+        }
+        indexWriter.add(nanos, level);
+    }
+    inline void needCreateNewLogFile(int64_t nanos)  // 判断是否需要创建新的日志文件
     {
-        if(getDate().compare(logCreateDate) != 0) {
-            // 创建新的日志文件
+        if(nanos >= nextRotateNanos) {  // 跨过零点, 创建新的日志文件
             createLogFile();
-            logCreateDate = getDate();
             // std::cout << "create new log file: " << logCreateDate << std::endl;
+        } else if (rotation.maxFileSize > 0 && fileWriter.currentSize() >= rotation.maxFileSize) {
+            rotateLogFile();    // 超过大小上限, 按序号切换
         }
     }
-    inline void writeLog(LogLevel level, const std::string date, const std::string& message)  // 写入日志
+    inline void writeLog(LogLevel level, int64_t nanos, const char* text, size_t length)  // 写入日志
     {
-        needCreateNewLogFile();
-#if defined(_WIN32) || defined(_WIN64)
-        if (logFileHandle!= INVALID_HANDLE_VALUE) {      // 输出到文件
-            if(level < LV_CLOSE) {
-                std::string logMessage = "[" + date + "] [" + LogLevelNames[level] + "] " + message + "\r\n";
-                DWORD bytesWritten = 0;
-                WriteFile(logFileHandle, logMessage.c_str(), logMessage.length(), &bytesWritten, NULL);  
-            }
+        if (shmRing.isOpen()) {
+            writeShm(level, nanos, &text, &length, 1);
+            return;
         }
-#else
-        if (logfp.is_open()) {      // 输出到文件
-            if(level < LV_CLOSE) logfp << "[" << date << "] [" << LogLevelNames[level] << "] " << message << std::endl;
-            else logfp << "[" << date << "] " << message << std::endl;
-            logfp.flush();
+        needCreateNewLogFile(nanos);
+        timeFormatter.setPrecision(static_cast<LogTimePrecision>(timePrecision.load(std::memory_order_relaxed)));
+        if (!fileWriter.isOpen()) return;
+        indexRecord(nanos, level, LogBinaryEncoder::textBound(length));
+        if (binaryFile) {   // 二进制格式: 时间和级别由记录头表示
+            char* begin = fileWriter.reserve(LogBinaryEncoder::textBound(length));
+            char* p = binaryEncoder.text(begin, level, nanos, text, length);
+            fileWriter.commit(p - begin, level, nanos);
+            return;
         }
-#endif 
+        // 直接格式化到写缓冲区: [时间] [级别] 内容
+        char* begin = fileWriter.reserve(LogTimeFormatter::MAX_LENGTH + length + 32);
+        char* p = begin;
+        *p++ = '[';
+        p += timeFormatter.format(nanos, p);
+        *p++ = ']';
+        *p++ = ' ';
+        if (level < LV_CLOSE) {
+            const std::string& name = LogLevelNames[level];
+            *p++ = '[';
+            std::memcpy(p, name.data(), name.size());
+            p += name.size();
+            *p++ = ']';
+            *p++ = ' ';
+        }
+        std::memcpy(p, text, length);
+        p += length;
+#if defined(_WIN32) || defined(_WIN64)
+        *p++ = '\r';
+#endif
+        *p++ = '\n';
+        fileWriter.commit(p - begin, level, nanos);
     }
     inline void addLogQueue(LogLevel level, const std::string& message) // 添加到日志队列中
     {
-        std::string datetime = getDateTime();
-        if (outputToTerminal) {     // 输出到终端
-            if(level < LV_CLOSE) std::cout << "[" << datetime << "] [" << LogLevelColors[level] << LogLevelNames[level] << LogLevelReset << "] " << message << std::endl;
-            else std::cout << "[" << datetime << "] " << message << std::endl;
+        size_t pos;
+        LogThreadBuffer* local;
+        LogMessage* slot = acquireSlot(pos, level, local);
+        if (slot == nullptr) return;    // 队列满, 按策略丢弃
+        slot->level = level;
+        slot->fileLevel = static_cast<uint8_t>(logLevel.load(std::memory_order_relaxed));
+        slot->timestamp = LogClock::raw();  // 取得槽位后再采样, 队列满等待时不会产生过旧的时间戳
+        slot->schema = nullptr;
+        std::memcpy(reserveData(*slot, message.size()), message.data(), message.size());
+        slot->length = static_cast<uint32_t>(message.size());
+        publishSlot(pos, local);
+    }
+    inline void addLogQueue(LogLevel level, int fileLevel, const char* fmt, va_list args) // 格式化到队列槽位中(不分配内存, 超长时使用溢出块)
+    {
+        if (level >= fileLevel && shmRing.isOpen()) {  // 共享内存传输: 调用线程直接写入共享内存, 发布即已提交
+            producers.enter();  // 停止时 shutdown 等写入完成后才关闭共享内存
+            bool live = running.load(std::memory_order_seq_cst);
+            if (live) logShm(level, fmt, args);
+            producers.leave();
+            if (!live) return;
+            if (!outputToTerminal.load(std::memory_order_relaxed) || level < consoleLevel.load(std::memory_order_relaxed)) return;
+            fileLevel = LV_CLOSE;   // 队列中的这条只输出到终端
+        }
+        size_t pos;
+        LogThreadBuffer* local;
+        LogMessage* slot = acquireSlot(pos, level, local);
+        if (slot == nullptr) return;    // 队列满, 按策略丢弃
+        slot->level = level;
+        slot->fileLevel = static_cast<uint8_t>(fileLevel);
+        slot->timestamp = LogClock::raw();  // 取得槽位后再采样, 队列满等待时不会产生过旧的时间戳
+        slot->schema = nullptr;
+        slot->spill = nullptr;
+        va_list args_copy;
+        va_copy(args_copy, args);
+        int size = std::vsnprintf(slot->inlineData, LOG_MESSAGE_INLINE_SIZE, fmt, args_copy);
+        va_end(args_copy);
+        if (size < 0) size = 0;
+        if (static_cast<size_t>(size) >= LOG_MESSAGE_INLINE_SIZE) {    // 内联缓冲区放不下, 重新格式化到溢出块
+            std::vsnprintf(reserveData(*slot, size + 1), size + 1, fmt, args);
         }
-        std::unique_lock<std::mutex> lock(logQueueMtx);
-        logQueue.push({level, datetime, message});
-        cv.notify_one(); // 唤醒等待的线程
+        slot->length = static_cast<uint32_t>(size);
+        publishSlot(pos, local);
+    }
+    // 外部来源的一条已格式化日志(使用给定时间), logd 转发共享内存中其他进程的日志时调用
+    // 不再按文件级别过滤: 产生日志的进程已按自己的级别过滤过
+    inline void logRecord(LogLevel level, int64_t nanos, const char* text, size_t length)
+    {
+        if (level < LV_TRACE || level > LV_CLOSE || !running.load(std::memory_order_relaxed)) return;
+        size_t pos;
+        LogThreadBuffer* local;
+        LogMessage* slot = acquireSlot(pos, level, local);
+        if (slot == nullptr) return;    // 队列满, 按策略丢弃
+        slot->level = level;
+        slot->fileLevel = LV_TRACE;
+        slot->timestamp = LogClock::fromNanos(nanos);
+        slot->schema = nullptr;
+        std::memcpy(reserveData(*slot, length), text, length);
+        slot->length = static_cast<uint32_t>(length);
+        publishSlot(pos, local);
+    }
+    inline void writeTerminal(LogLevel level, int64_t nanos, const char* text, size_t length) // 输出到终端(日志线程批量写入)
+    {
+        int color = consoleColor.load(std::memory_order_relaxed);
+        bool colored = color > 0 || (color < 0 && consoleIsTerminal);   // 非终端(管道/journald)时自动关闭颜色
+        consoleFormatter.setPrecision(static_cast<LogTimePrecision>(timePrecision.load(std::memory_order_relaxed)));
+        char* begin = consoleWriter.reserve(LogTimeFormatter::MAX_LENGTH + length + 48);
+        char* p = begin;
+        *p++ = '[';
+        p += consoleFormatter.format(nanos, p);
+        *p++ = ']';
+        *p++ = ' ';
+        if (level < LV_CLOSE) {
+            *p++ = '[';
+            if (colored) p = appendText(p, LogLevelColors[level]);
+            p = appendText(p, LogLevelNames[level]);
+            if (colored) p = appendText(p, LogLevelReset);
+            *p++ = ']';
+            *p++ = ' ';
+        }
+        std::memcpy(p, text, length);
+        p += length;
+        *p++ = '\n';
+        consoleWriter.commit(p - begin, level);
     }
 
 protected:
-    inline std::string format(const char *fmt, va_list args) // 格式化日志消息
+    static inline char* appendText(char* p, const std::string& text)
+    {
+        std::memcpy(p, text.data(), text.size());
+        return p + text.size();
+    }
+    inline void updateEnabledLevel()  // 重新计算调用方判断用的最低级别
+    {
+        int level = logLevel.load(std::memory_order_relaxed);
+        if (outputToTerminal.load(std::memory_order_relaxed)) {
+            level = std::min(level, consoleLevel.load(std::memory_order_relaxed));
+        }
+        outputLevel.store(level, std::memory_order_relaxed);
+        if (flightCapacity.load(std::memory_order_relaxed) > 0) {
+            level = std::min(level, flightLevel.load(std::memory_order_relaxed));
+        }
+        enabledLevel.store(level, std::memory_order_relaxed);
+        refreshSites();
+    }
+    inline int globalSiteLevels() const  // 不按调用点区分时的打包级别(公开的 log/logDeferred/logFormat 接口使用)
+    {
+        return logSitePack(enabledLevel.load(std::memory_order_relaxed), logLevel.load(std::memory_order_relaxed),
+                           outputLevel.load(std::memory_order_relaxed));
+    }
+    // 按当前配置快照计算调用点的级别: 源文件配置优先于模块配置, 都没有时使用 log_level; 未运行时关闭
+    inline int computeSiteLevels(const LogSiteLevel& site, const LogConfigSnapshot& snapshot) const
+    {
+        int file = logLevel.load(std::memory_order_relaxed);
+        if (site.module != nullptr && !snapshot.moduleLevels.empty()) {
+            std::map<std::string, int>::const_iterator it = snapshot.moduleLevels.find(site.module->name());
+            if (it != snapshot.moduleLevels.end()) file = it->second;
+        }
+        if (site.file != nullptr && !snapshot.fileLevels.empty()) {
+            std::map<std::string, int>::const_iterator it = snapshot.fileLevels.find(my_basename(site.file));
+            if (it != snapshot.fileLevels.end()) file = it->second;
+        }
+        file = std::max<int>(LV_TRACE, std::min<int>(file, LV_CLOSE));
+        int output = file;
+        if (outputToTerminal.load(std::memory_order_relaxed)) output = std::min(output, consoleLevel.load(std::memory_order_relaxed));
+        int enabled = output;
+        if (flightCapacity.load(std::memory_order_relaxed) > 0) enabled = std::min(enabled, flightLevel.load(std::memory_order_relaxed));
+        if (!running.load(std::memory_order_relaxed)) enabled = LV_CLOSE + 1;
+        return logSitePack(enabled, file, output);
+    }
+    inline int resolveSite(LogSiteLevel& site, const LogModule* module)  // 调用点首次判断: 登记并计算级别缓存
+    {
+        std::lock_guard<std::mutex> lock(siteMtx);
+        int levels = site.levels.load(std::memory_order_relaxed);
+        if (levels & LOG_SITE_RESOLVED) return levels;  // 其他线程已登记
+        site.module = module;
+        site.next = sites;
+        sites = &site;
+        levels = computeSiteLevels(site, *std::atomic_load(&config));
+        site.levels.store(levels, std::memory_order_relaxed);
+        return levels;
+    }
+    inline void refreshSites()  // 级别或配置变化后重新计算所有已登记调用点的级别缓存
+    {
+        std::lock_guard<std::mutex> lock(siteMtx);
+        std::shared_ptr<const LogConfigSnapshot> snapshot = std::atomic_load(&config);
+        for (LogSiteLevel* site = sites; site != nullptr; site = site->next) {
+            site->levels.store(computeSiteLevels(*site, *snapshot), std::memory_order_relaxed);
+        }
+    }
+    template <typename F>
+    inline void updateConfig(F change)  // 复制当前快照, 修改后整体替换
+    {
+        {
+            std::lock_guard<std::mutex> lock(configMtx);
+            std::shared_ptr<LogConfigSnapshot> snapshot = std::make_shared<LogConfigSnapshot>(*std::atomic_load(&config));
+            change(*snapshot);
+            std::atomic_store(&config, std::shared_ptr<const LogConfigSnapshot>(snapshot));
+        }
+        refreshSites();
+    }
+    inline void applyWriterConfig()  // 日志线程应用新的刷盘/切换策略
+    {
+        if (!writerConfigChanged.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(configMtx);
+        fileWriter.setPolicy(flushPolicy);
+        bool binary = fileFormat == LOG_FORMAT_BINARY && !shmRing.isOpen();     // 共享内存中只传递文本
+        fileWriter.setCompression(streamCompress);  // 未启用 zlib 时保持不压缩
+        bool compressed = fileWriter.getCompression();
+        if (fileSink != fileWriter.getSink() || binary != binaryFile || compressed != compressedFile) {
+            fileWriter.setSink(fileSink);
+            binaryFile = binary;
+            compressedFile = compressed;
+            if (fileWriter.isOpen()) {  // 以新的输出方式或格式重新打开当天的日志文件
+                closeLogFile();
+                openLogFile(std::string());
+            }
+        }
+        if (indexInterval != indexBlockSize) {  // 索引块大小变化时从当前位置开始新的索引文件块
+            indexWriter.close(fileWriter.currentSize());
+            indexBlockSize = indexInterval;
+            if (fileWriter.isOpen()) openIndexFile();
+        }
+        bool retentionChanged = rotationPolicy.maxFiles != rotation.maxFiles || rotationPolicy.maxTotalSize != rotation.maxTotalSize;
+        rotation = rotationPolicy;
+        if (retentionChanged && fileWriter.isOpen()) archiver.submit(logDir, logModuleName, std::string(), logFileName, rotation);
+        writerConfigChanged.store(false, std::memory_order_relaxed);
+    }
+    inline void drainQueue()  // 取空队列(日志线程, 或 shutdown 时的调用线程)
     {
+        size_t pos;
+        LogMessage* msg;
+        size_t threadDepth = collectThreadBuffers();
+        updateHighWater(logQueue->size() + threadDepth);
+        while((msg = logQueue->tryConsume(pos)) != nullptr) {
+            consumeMessage(*msg);
+            logQueue->release(pos);
+            if (crashing.load(std::memory_order_acquire)) parkForCrash();
+        }
+        mergeThreadBuffers();
+    }
+    // 扫描线程私有队列: 把非空队列的队头放入归并堆, 回收已退出且已取空的队列; 返回各队列日志总数
+    inline size_t collectThreadBuffers()
+    {
+        mergeHeap.clear();
+        size_t depth = 0;
+        size_t count = 0;
+        size_t slots = threadBufferSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < slots; ++i) {
+            LogThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+            if (buffer == nullptr) continue;
+            bool retired = buffer->retired.load(std::memory_order_acquire);  // 先读退出标记再看队列, 退出前发布的日志不会丢
+            LogMessage* msg = buffer->ring.front();
+            if (msg != nullptr) {
+                LogMergeEntry entry;
+                entry.timestamp = msg->timestamp;
+                entry.index = i;
+                entry.remaining = buffer->ring.size();
+                mergeHeap.push_back(entry);
+                depth += entry.remaining;
+                ++count;
+            } else if (retired) {
+                threadBuffers[i].store(nullptr, std::memory_order_release);
+                delete buffer;
+            } else {
+                ++count;
+            }
+        }
+        std::make_heap(mergeHeap.begin(), mergeHeap.end(), LogMergeEntry::later);
+        threadQueueDepth.store(depth, std::memory_order_relaxed);
+        threadQueueCount.store(count, std::memory_order_relaxed);
+        return depth;
+    }
+    // 按时间戳 k 路归并各线程私有队列, 使日志文件整体有序
+    inline void mergeThreadBuffers()
+    {
+        while (!mergeHeap.empty()) {
+            std::pop_heap(mergeHeap.begin(), mergeHeap.end(), LogMergeEntry::later);
+            LogMergeEntry& entry = mergeHeap.back();
+            LogSpscRing<LogMessage>& ring = threadBuffers[entry.index].load(std::memory_order_relaxed)->ring;
+            consumeMessage(*ring.front());
+            ring.pop();
+            if (crashing.load(std::memory_order_acquire)) parkForCrash();
+            LogMessage* next = --entry.remaining > 0 ? ring.front() : nullptr;
+            if (next == nullptr) {
+                mergeHeap.pop_back();
+                continue;
+            }
+            entry.timestamp = next->timestamp;
+            std::push_heap(mergeHeap.begin(), mergeHeap.end(), LogMergeEntry::later);
+        }
+        threadQueueDepth.store(0, std::memory_order_relaxed);
+    }
+    // 当前线程的私有队列, 首次调用时创建并登记; 登记表已满时返回 nullptr(使用共享队列)
+    inline LogThreadBuffer* threadBuffer()
+    {
+        static thread_local LogThreadBufferHolder holder;
+        if (holder.registered) return holder.buffer;
+        holder.registered = true;
+        static thread_local LogThreadExit<LogThreadBufferHolder> exitHook;
+        exitHook.holder = &holder;
+        LogThreadBuffer* buffer = new LogThreadBuffer(threadQueueCapacity.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < LOG_MAX_THREAD_BUFFERS; ++i) {
+            LogThreadBuffer* expected = nullptr;
+            if (threadBuffers[i].compare_exchange_strong(expected, buffer, std::memory_order_acq_rel)) {
+                size_t slots = threadBufferSlots.load(std::memory_order_relaxed);
+                while (slots < i + 1 && !threadBufferSlots.compare_exchange_weak(slots, i + 1, std::memory_order_release)) {}
+                holder.buffer = buffer;
+                return buffer;
+            }
+        }
+        delete buffer;
+        return nullptr;
+    }
+    // 当前线程的飞行记录器, 首次调用时创建并登记; 登记表已满或容量为 0 时返回 nullptr
+    inline LogFlightRing* flightRing()
+    {
+        static thread_local LogFlightHolder holder;
+        if (holder.registered) return holder.ring;
+        size_t capacity = flightCapacity.load(std::memory_order_relaxed);
+        if (capacity == 0) return nullptr;
+        holder.registered = true;
+        static thread_local LogThreadExit<LogFlightHolder> exitHook;
+        exitHook.holder = &holder;
+        LogFlightRing* ring = new LogFlightRing(capacity);
+        for (size_t i = 0; i < LOG_MAX_THREAD_BUFFERS; ++i) {
+            LogFlightRing* expected = nullptr;
+            if (flightRings[i].compare_exchange_strong(expected, ring, std::memory_order_acq_rel)) {
+                size_t slots = flightRingSlots.load(std::memory_order_relaxed);
+                while (slots < i + 1 && !flightRingSlots.compare_exchange_weak(slots, i + 1, std::memory_order_release)) {}
+                holder.ring = ring;
+                return ring;
+            }
+        }
+        delete ring;
+        return nullptr;
+    }
+    // 取得当前线程飞行记录器的下一个槽位(标记为写入中), 写完内容后调用 flightCommit
+    inline LogMessage* flightSlot(LogLevel level)
+    {
+        LogFlightRing* ring = flightRing();
+        if (ring == nullptr) return nullptr;
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        LogFlightEntry& entry = ring->entries[head % ring->entries.size()];
+        entry.seq.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.msg.level = level;
+        entry.msg.timestamp = LogClock::raw();
+        entry.msg.site = nullptr;
+        entry.msg.schema = nullptr;
+        entry.msg.spill = nullptr;
+        return &entry.msg;
+    }
+    inline void flightCommit()
+    {
+        LogFlightRing* ring = flightRing();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        ring->entries[head % ring->entries.size()].seq.store(2 * (head + 1), std::memory_order_release);
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+    // 飞行记录器中放不下的日志只保存格式串
+    static inline size_t logFlightText(char* p, const char* fmt)
+    {
+        static const char prefix[] = "[truncated] ";
+        size_t n = std::min(std::strlen(fmt), LOG_MESSAGE_INLINE_SIZE - sizeof(prefix));
+        std::memcpy(p, prefix, sizeof(prefix) - 1);
+        std::memcpy(p + sizeof(prefix) - 1, fmt, n);
+        return sizeof(prefix) - 1 + n;
+    }
+    // 转储各线程飞行记录器中时间不晚于 cutoff 且尚未转储的日志, 按时间排序后写入日志文件(不受文件级别限制)
+    inline void dumpFlight(uint64_t cutoff, const char* reason)
+    {
+        flightDump.clear();
+        size_t slots = flightRingSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < slots; ++i) {
+            LogFlightRing* ring = flightRings[i].load(std::memory_order_acquire);
+            if (ring == nullptr) continue;
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t capacity = ring->entries.size();
+            uint64_t pos = std::max(ring->dumped, head > capacity ? head - capacity : 0);
+            for (; pos != head; ++pos) {
+                const LogFlightEntry& entry = ring->entries[pos % capacity];
+                uint64_t seq = entry.seq.load(std::memory_order_acquire);
+                LogMessage msg = entry.msg;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq != 2 * (pos + 1) || entry.seq.load(std::memory_order_relaxed) != seq) continue;    // 已被覆盖
+                if (msg.timestamp > cutoff) break;  // 晚于触发时间, 留给下次转储
+                flightDump.push_back(msg);
+            }
+            ring->dumped = pos;
+        }
+        if (flightDump.empty()) return;
+        std::stable_sort(flightDump.begin(), flightDump.end(), [](const LogMessage& a, const LogMessage& b) {
+            return a.timestamp < b.timestamp;
+        });
+        char text[128];     // 提示行使用首末条日志的时间, 文件内时间保持有序
+        int n = std::snprintf(text, sizeof(text), "[logger] flight recorder: %zu messages before %s", flightDump.size(), reason);
+        writeLog(LV_INFO, LogClock::toNanos(flightDump.front().timestamp), text, std::min<size_t>(n, sizeof(text) - 1));
+        for (const LogMessage& msg : flightDump) {
+            int64_t nanos = LogClock::toNanos(msg.timestamp);
+            if (msg.schema == nullptr) {
+                writeLog(msg.level, nanos, msg.data(), msg.length);
+            } else if (binaryFile) {
+                writeEvent(msg, nanos);
+            } else {
+                formatDeferred(msg, deferredText);
+                writeLog(msg.level, nanos, deferredText.data(), deferredText.size());
+            }
+        }
+        n = std::snprintf(text, sizeof(text), "[logger] flight recorder: end");
+        writeLog(LV_INFO, LogClock::toNanos(flightDump.back().timestamp), text, n);
+    }
+    // 响应 dumpFlightRecorder/SIGUSR1 的转储请求, 并回收已退出线程的飞行记录器
+    // 回收分两步: 先记下退出标记, 再经过一次取空队列后删除, 保证该线程退出前入队的错误日志仍能转储它的上下文
+    inline void serveFlightDump()
+    {
+        if (flightDumpRequested.exchange(false, std::memory_order_acq_rel)) dumpFlight(LogClock::raw(), "dump request");
+        size_t slots = flightRingSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < slots; ++i) {
+            LogFlightRing* ring = flightRings[i].load(std::memory_order_acquire);
+            if (ring == nullptr) continue;
+            if (ring->retiredSeen) {
+                flightRings[i].store(nullptr, std::memory_order_release);
+                delete ring;
+            } else {
+                ring->retiredSeen = ring->retired.load(std::memory_order_acquire);
+            }
+        }
+    }
+    static inline void flightSignalHandler(int)
+    {
+        if (instance == nullptr) return;
+        instance->flightDumpRequested.store(true, std::memory_order_release);
+        instance->waiter.wakeFromSignal();
+    }
+    // 本轮处理完毕后等待下一批日志: 自旋、让出 CPU 后休眠, 写缓冲区中有未写出的日志时最多休眠到刷盘周期
+    inline void waitForWork()
+    {
+        if (waitMode.load(std::memory_order_relaxed) == LOG_WAIT_POLL) {
+            LOG_SLEEP(10); // 等待10毫秒
+            return;
+        }
+        int timeout = LOG_WAIT_PARK_MS;
+        if (fileWriter.pending() > 0 || consoleWriter.pending() > 0) timeout = std::max(1, fileWriter.getPolicy().intervalMs);
+        int stats = statsIntervalMs.load(std::memory_order_relaxed);
+        if (stats > 0) timeout = std::min(timeout, stats);
+        waiter.wait([this]() { return hasWork(); }, timeout);
+    }
+    inline bool hasWork()  // 日志线程是否有待处理的日志或请求(等待期间反复调用, 只读)
+    {
+        if (!running.load(std::memory_order_relaxed) || crashing.load(std::memory_order_relaxed)) return true;
+        if (logQueue->peek(logQueue->dequeuePosition()) != nullptr) return true;
+        if (flushRequests.load(std::memory_order_relaxed) != flushedRequest.load(std::memory_order_relaxed)) return true;
+        if (flightDumpRequested.load(std::memory_order_relaxed) || writerConfigChanged.load(std::memory_order_relaxed)) return true;
+        size_t slots = threadBufferSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < slots; ++i) {
+            LogThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+            if (buffer != nullptr && buffer->ring.front() != nullptr) return true;
+        }
+        return false;
+    }
+    inline void parkForCrash()  // 崩溃转储进行中: 日志线程停止处理, 把写缓冲区和队列交给信号处理函数
+    {
+        if (std::this_thread::get_id() != logThread.get_id()) return;
+        consumerParked.store(true, std::memory_order_release);
+        for (;;) LOG_SLEEP(100);
+    }
+    inline void serveFlush(uint64_t requests)  // 响应取批之前的 flush 请求: 写出缓冲区并通知等待的线程
+    {
+        if (requests == flushedRequest.load(std::memory_order_relaxed)) return;
+        fileWriter.flush();
+        consoleWriter.flush();
+        {
+            std::lock_guard<std::mutex> lock(flushMtx);
+            flushedPos.store(logQueue->dequeuePosition(), std::memory_order_release);
+            flushedRequest.store(requests, std::memory_order_release);
+        }
+        flushCv.notify_all();
+    }
+    static inline void shutdownAtExit()
+    {
+        if (instance != nullptr) instance->shutdown();
+    }
+    static inline void crashSignalHandler(int sig)
+    {
+        static std::atomic<bool> handling{false};
+        if (!handling.exchange(true) && instance != nullptr) instance->dumpPending(sig);
+        std::signal(sig, SIG_DFL);  // 恢复默认处理并重新触发, 保留 core dump 和退出码
+        std::raise(sig);
+    }
+    // 崩溃转储(异步信号安全: 不分配内存、不加锁、不调用 stdio), 尽力写出写缓冲区和队列中已发布的日志
+    // 时间戳输出为纪元秒.纳秒; 延迟格式化的日志只输出调用点和格式串
+    inline void dumpPending(int sig)
+    {
+        crashing.store(true, std::memory_order_release);
+        waiter.wakeFromSignal();    // 日志线程可能在休眠, 唤醒后才会停下
+        if (logThread.joinable() && std::this_thread::get_id() != logThread.get_id()) {
+            // 等待日志线程写完当前一条后停下(最多约 200 毫秒; usleep 不是异步信号安全的, 使用 nanosleep)
+#if defined(_WIN32) || defined(_WIN64)
+            for (int i = 0; i < 200 && !consumerParked.load(std::memory_order_acquire); ++i) Sleep(1);
+#else
+            struct timespec pause = {0, 1000000};
+            for (int i = 0; i < 200 && !consumerParked.load(std::memory_order_acquire); ++i) nanosleep(&pause, nullptr);
+#endif
+        }
+        fileWriter.flushForCrash();
+        consoleWriter.flush();
+        size_t begin = logQueue->dequeuePosition();
+        size_t end = logQueue->enqueuePosition();
+        size_t pending = end - begin;
+        size_t slots = threadBufferSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < slots; ++i) {
+            LogThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+            if (buffer != nullptr) pending += buffer->ring.size();
+        }
+        char line[128];
+        char* p = appendRaw(line, "[logger] crash: signal ");
+        p = appendUnsigned(p, static_cast<uint64_t>(sig));
+        p = appendRaw(p, ", pending messages: ");
+        p = appendUnsigned(p, pending);
+        if (binaryFile || shmRing.isOpen()) {
+            const char* parts[] = { line };
+            size_t lengths[] = { static_cast<size_t>(p - line) };
+            dumpRecord(LV_CLOSE, LogClock::nowNanos(), parts, lengths, 1);
+        } else {
+            *p++ = '\n';
+            fileWriter.writeRaw(line, p - line);
+        }
+        size_t flightSlots = flightRingSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < flightSlots; ++i) {  // 飞行记录器中尚未转储的日志按线程依次输出
+            LogFlightRing* ring = flightRings[i].load(std::memory_order_acquire);
+            if (ring == nullptr) continue;
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t capacity = ring->entries.size();
+            uint64_t from = std::max(ring->dumped, head > capacity ? head - capacity : 0);
+            for (uint64_t pos = from; pos != head; ++pos) {
+                const LogFlightEntry& entry = ring->entries[pos % capacity];
+                uint64_t seq = entry.seq.load(std::memory_order_acquire);
+                LogMessage msg = entry.msg;     // 先拷贝再校验序号, 丢弃崩溃时正在写入或被覆盖的槽位
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq == 2 * (pos + 1) && entry.seq.load(std::memory_order_relaxed) == seq) dumpMessage(msg);
+            }
+        }
+        for (size_t pos = begin; pos != end; ++pos) {
+            const LogMessage* msg = logQueue->peek(pos);
+            if (msg != nullptr) dumpMessage(*msg);  // 跳过尚未发布的槽位
+        }
+        for (size_t i = 0; i < slots; ++i) {    // 线程私有队列按线程依次输出(不归并)
+            LogThreadBuffer* buffer = threadBuffers[i].load(std::memory_order_acquire);
+            if (buffer == nullptr) continue;
+            size_t tail = buffer->ring.tailPosition();
+            for (size_t pos = buffer->ring.headPosition(); pos != tail; ++pos) dumpMessage(*buffer->ring.at(pos));
+        }
+        fileWriter.trim();  // mmap 方式: 去掉预先扩展出的文件末尾; 流式压缩: 写出最后一帧
+    }
+    // 崩溃转储一条日志(异步信号安全)
+    // 文本文件: "[纪元秒.纳秒] [级别] 内容"; 二进制文件写为文本记录, 时间和级别由记录头表示
+    // 延迟格式化的日志内容为 "[deferred 源文件:行号] 格式串"
+    inline void dumpMessage(const LogMessage& msg)
+    {
+        char prefix[64];
+        char site[32];
+        const char* parts[5];
+        size_t lengths[5];
+        int count = 0;
+        int64_t nanos = LogClock::toNanos(msg.timestamp);
+        bool record = binaryFile || shmRing.isOpen();   // 时间和级别由记录头表示
+        if (!record) {
+            char* p = prefix;
+            *p++ = '[';
+            p = appendUnsigned(p, static_cast<uint64_t>(nanos / 1000000000LL));
+            *p++ = '.';
+            uint64_t frac = static_cast<uint64_t>(nanos % 1000000000LL);
+            for (uint64_t div = 100000000; div > 0; div /= 10) *p++ = static_cast<char>('0' + frac / div % 10);
+            p = appendRaw(p, "] [");
+            if (msg.level < LV_CLOSE) p = appendText(p, LogLevelNames[msg.level]);
+            p = appendRaw(p, "] ");
+            parts[count] = prefix;
+            lengths[count++] = p - prefix;
+        }
+        if (msg.schema != nullptr) {
+            parts[count] = "[deferred ";
+            lengths[count++] = 10;
+            parts[count] = msg.site->file;
+            lengths[count++] = std::strlen(msg.site->file);
+            char* p = site;
+            *p++ = ':';
+            p = appendUnsigned(p, static_cast<uint64_t>(msg.site->line));
+            p = appendRaw(p, "] ");
+            parts[count] = site;
+            lengths[count++] = p - site;
+            parts[count] = msg.site->fmt;
+            lengths[count++] = std::strlen(msg.site->fmt);
+        } else {
+            parts[count] = msg.data();
+            lengths[count++] = msg.length;
+        }
+        if (record) {
+            dumpRecord(msg.level, nanos, parts, lengths, count);
+        } else {
+            for (int i = 0; i < count; ++i) fileWriter.writeRaw(parts[i], lengths[i]);
+            fileWriter.writeRaw("\n", 1);
+        }
+    }
+    // 崩溃转储: 把若干段内容写为一条二进制文本记录, 共享内存传输时写入共享内存(异步信号安全)
+    inline void dumpRecord(int level, int64_t nanos, const char* const* parts, const size_t* lengths, int count)
+    {
+        if (shmRing.isOpen()) {
+            shmRing.push(level, nanos, parts, lengths, count);
+            return;
+        }
+        size_t total = 0;
+        for (int i = 0; i < count; ++i) total += lengths[i];
+        char head[32];
+        char* p = binaryEncoder.textHeader(head, level, nanos, total);
+        fileWriter.writeRaw(head, p - head);
+        for (int i = 0; i < count; ++i) fileWriter.writeRaw(parts[i], lengths[i]);
+    }
+    static inline char* appendRaw(char* p, const char* text)
+    {
+        while (*text) *p++ = *text++;
+        return p;
+    }
+    static inline char* appendUnsigned(char* p, uint64_t value)
+    {
+        char digits[20];
+        int n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value);
+        while (n > 0) *p++ = digits[--n];
+        return p;
+    }
+    inline void consumeMessage(LogMessage& msg)  // 日志线程处理一条出队日志并更新统计
+    {
+        enqueued[msg.level].fetch_add(1, std::memory_order_relaxed);
+        if (msg.level >= flightDumpLevel.load(std::memory_order_relaxed) && flightRingSlots.load(std::memory_order_relaxed) > 0) {
+            dumpFlight(msg.timestamp, LogLevelNames[msg.level].c_str());  // 先写出错误之前的上下文
+        }
+        bool output = processMessage(msg);
+        releaseData(msg);
+        if (!output) return;
+        written[msg.level].fetch_add(1, std::memory_order_relaxed);
+        int64_t lag = LogClock::nowNanos() - LogClock::toNanos(msg.timestamp);
+        enqueueLatency.record(lag > 0 ? static_cast<uint64_t>(lag) : 0);
+    }
+    inline bool processMessage(const LogMessage& msg)  // 日志线程处理一条日志(格式化并写入各输出端), 返回是否有输出
+    {
+        bool toFile = msg.level >= msg.fileLevel;    // 文件级别由调用点在入队时确定(可按模块/源文件配置)
+        bool toTerminal = outputToTerminal.load(std::memory_order_relaxed) && msg.level >= consoleLevel.load(std::memory_order_relaxed);
+        if (!toFile && !toTerminal) return false;
+        int64_t nanos = LogClock::toNanos(msg.timestamp);
+        if (toFile && binaryFile && msg.schema != nullptr) {  // 二进制格式直接写入调用点编号和参数, 不需要格式化
+            writeEvent(msg, nanos);
+            if (!toTerminal) return true;
+            toFile = false;
+        }
+        const char* text = msg.data();
+        size_t length = msg.length;
+        if (msg.schema != nullptr) {   // 延迟格式化的消息在此完成格式化
+            formatDeferred(msg, deferredText);
+            text = deferredText.data();
+            length = deferredText.size();
+        }
+        if (toFile) writeLog(msg.level, nanos, text, length);          // 写入日志
+        if (toTerminal) writeTerminal(msg.level, nanos, text, length); // 输出到终端
+        return true;
+    }
+    inline void writeEvent(const LogMessage& msg, int64_t nanos)  // 延迟日志写入二进制文件
+    {
+        needCreateNewLogFile(nanos);
+        if (!fileWriter.isOpen()) return;
+        // indexRecord 可能写入文件头并清空调用点字典, 记录长度须在其之后计算
+        indexRecord(nanos, msg.level, LogBinaryEncoder::eventMaxBound(msg.site, msg.schema, msg.length));
+        char* begin = fileWriter.reserve(binaryEncoder.eventBound(msg.site, msg.schema, msg.length));
+        char* p = binaryEncoder.event(begin, msg.level, nanos, msg.site, msg.schema, msg.data());
+        fileWriter.commit(p - begin, msg.level, nanos);
+    }
+    inline bool selectOutputs(LogLevel level, bool& toFile, bool& toTerminal)  // 判断该级别日志写入哪些输出端
+    {
+        toFile = level >= logLevel.load(std::memory_order_relaxed);
+        toTerminal = outputToTerminal.load(std::memory_order_relaxed) && level >= consoleLevel.load(std::memory_order_relaxed);
+        return toFile || toTerminal;
+    }
+    // 调用线程格式化后直接写入共享内存; 达到转储级别时请求日志线程转储飞行记录器(上下文写在这条日志之后)
+    inline void logShm(LogLevel level, const char* fmt, va_list args)
+    {
+        char buffer[512];
         va_list args_copy;
         va_copy(args_copy, args);
-        int size = std::vsnprintf(NULL, 0, fmt, args_copy);
+        int size = std::vsnprintf(buffer, sizeof(buffer), fmt, args_copy);
         va_end(args_copy);
-        
-        std::string result(size+1, '\0');
-        std::vsnprintf(&result.front(), size+1, fmt, args);
-
-        return result;
+        if (size < 0) size = 0;
+        const char* text = buffer;
+        size_t length = static_cast<size_t>(size);
+        LogSpillBlock* spill = nullptr;
+        if (length >= sizeof(buffer)) {     // 超长日志重新格式化到溢出块(与入队路径共用溢出块池, 预热后不分配内存)
+            spill = spillPool.acquire(length + 1);
+            va_copy(args_copy, args);
+            std::vsnprintf(spill->data(), length + 1, fmt, args_copy);
+            va_end(args_copy);
+            text = spill->data();
+        }
+        writeShm(level, LogClock::nowNanos(), &text, &length, 1);
+        if (spill != nullptr) spillPool.release(spill);
+        if (level >= flightDumpLevel.load(std::memory_order_relaxed) && flightRingSlots.load(std::memory_order_relaxed) > 0) {
+            flightDumpRequested.store(true, std::memory_order_release);
+            waiter.wake();
+        }
+    }
+    // 写入共享内存队列; 队列满时 block 策略在 logd 存活期间等待, 其他策略(或没有 logd)丢弃并计入丢弃数
+    inline bool writeShm(int level, int64_t nanos, const char* const* parts, const size_t* lengths, int count)
+    {
+        while (!shmRing.push(level, nanos, parts, lengths, count)) {
+            int policy = overflowPolicy.load(std::memory_order_relaxed);
+            if (policy == LOG_OVERFLOW_DROP_BELOW_LEVEL) {
+                policy = level < overflowLevel.load(std::memory_order_relaxed) ? LOG_OVERFLOW_DROP_NEWEST : LOG_OVERFLOW_BLOCK;
+            }
+            if (policy != LOG_OVERFLOW_BLOCK || !shmRing.collectorAlive(LogClock::nowNanos())) {    // 停止时也等待, 由 logd 取走剩余日志
+                dropped[std::min(level, static_cast<int>(LV_CLOSE))].fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+    inline void writeInternal(LogLevel level, const char* text, int length)  // 日志线程写入自身的提示信息(丢弃数、统计)
+    {
+        bool toFile, toTerminal;
+        if (length <= 0 || !selectOutputs(level, toFile, toTerminal)) return;
+        int64_t nanos = LogClock::nowNanos();
+        if (toFile) writeLog(level, nanos, text, length);
+        if (toTerminal) writeTerminal(level, nanos, text, length);
+    }
+    // 取得槽位内容区: 内联缓冲区放不下时从溢出块池取块(预热后不再分配内存)
+    inline char* reserveData(LogMessage& slot, size_t size)
+    {
+        if (size <= LOG_MESSAGE_INLINE_SIZE) {
+            slot.spill = nullptr;
+            return slot.inlineData;
+        }
+        slot.spill = spillPool.acquire(size);
+        return slot.spill->data();
+    }
+    inline void releaseData(LogMessage& msg)  // 归还溢出块(日志线程处理完一条日志后调用)
+    {
+        if (msg.spill == nullptr) return;
+        spillPool.release(msg.spill);
+        msg.spill = nullptr;
+    }
+    inline void updateHighWater(size_t depth)  // 记录队列深度峰值(日志线程在每批开始时调用)
+    {
+        if (depth > queueHighWater.load(std::memory_order_relaxed)) queueHighWater.store(depth, std::memory_order_relaxed);
+    }
+    inline void reportStats()  // 按 stats_interval_ms 周期把统计信息写入日志
+    {
+        int interval = statsIntervalMs.load(std::memory_order_relaxed);
+        if (interval <= 0) return;
+        int64_t now = LogClock::nowNanos();
+        if (now - lastStatsNanos < static_cast<int64_t>(interval) * 1000000LL) return;
+        lastStatsNanos = now;
+        LogStats s = stats();
+        uint64_t totalEnqueued = 0, totalWritten = 0, totalDropped = 0;
+        for (int i = 0; i <= LV_CLOSE; ++i) {
+            totalEnqueued += s.enqueued[i];
+            totalWritten += s.written[i];
+            totalDropped += s.dropped[i];
+        }
+        char text[512];
+        int n = std::snprintf(text, sizeof(text), "[logger] stats: enqueued=%llu written=%llu dropped=%llu bytes=%llu syscalls=%llu queue=%zu/%zu/%zu "
+            "latency_us(p50/p99/max)=%.1f/%.1f/%.1f write_us(p50/p99/max)=%.1f/%.1f/%.1f",
+            static_cast<unsigned long long>(totalEnqueued), static_cast<unsigned long long>(totalWritten),
+            static_cast<unsigned long long>(totalDropped), static_cast<unsigned long long>(s.writer.bytes),
+            static_cast<unsigned long long>(s.writer.syscalls), s.queueDepth, s.queueHighWater, s.queueCapacity,
+            s.latency.percentile(0.50) / 1e3, s.latency.percentile(0.99) / 1e3, s.latency.max / 1e3,
+            s.writeLatency.percentile(0.50) / 1e3, s.writeLatency.percentile(0.99) / 1e3, s.writeLatency.max / 1e3);
+        writeInternal(LV_CLOSE, text, std::min<int>(n, sizeof(text) - 1));    // 不受日志级别过滤, 也不显示级别
+    }
+    inline void reportDropped()  // 定期把丢弃的日志数写入日志, 使日志缺口可见
+    {
+        uint64_t total = droppedCount();
+        if (total == droppedReported) return;
+        int64_t now = LogClock::nowNanos();
+        if (now - lastDropReportNanos < static_cast<int64_t>(dropReportIntervalMs) * 1000000LL) return;
+        char text[256];
+        int n = std::snprintf(text, sizeof(text), "[logger] %llu messages dropped (queue full), total by level: trace=%llu debug=%llu info=%llu warn=%llu error=%llu fatal=%llu",
+            static_cast<unsigned long long>(total - droppedReported),
+            static_cast<unsigned long long>(dropped[LV_TRACE].load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(dropped[LV_DEBUG].load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(dropped[LV_INFO].load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(dropped[LV_WARN].load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(dropped[LV_ERROR].load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(dropped[LV_FATAL].load(std::memory_order_relaxed)));
+        writeInternal(LV_WARN, text, std::min<int>(n, sizeof(text) - 1));
+        droppedReported = total;
+        lastDropReportNanos = now;
+    }
+    inline void publishSlot(size_t pos, LogThreadBuffer* local)  // 发布 acquireSlot 得到的槽位, 日志线程休眠时唤醒
+    {
+        if (local != nullptr) {
+            local->ring.publish();
+        } else {
+            logQueue->publish(pos);
+        }
+        waiter.notify();
+        producers.leave();
+    }
+    // 取得槽位并登记为正在写入的调用方(发布时注销); 已停止或被丢弃时返回 nullptr
+    inline LogMessage* acquireSlot(size_t& pos, LogLevel level, LogThreadBuffer*& local)
+    {
+        local = nullptr;
+        producers.enter();
+        LogMessage* slot = running.load(std::memory_order_seq_cst) ? reserveSlot(pos, level, local) : nullptr;
+        if (slot == nullptr) producers.leave();
+        return slot;
+    }
+    // 无锁抢占预分配槽位(私有队列模式下取当前线程队列的槽位), 队列满时按溢出策略处理; 返回 nullptr 表示当前日志被丢弃
+    inline LogMessage* reserveSlot(size_t& pos, LogLevel level, LogThreadBuffer*& local)
+    {
+        if (queueMode.load(std::memory_order_relaxed) == LOG_QUEUE_PER_THREAD && (local = threadBuffer()) != nullptr) {
+            return acquireLocalSlot(local->ring, level);
+        }
+        LogMessage* slot = logQueue->tryAcquire(pos);
+        if (slot != nullptr) return slot;
+        int policy = overflowPolicy.load(std::memory_order_relaxed);
+        if (policy == LOG_OVERFLOW_DROP_BELOW_LEVEL) {
+            policy = level < overflowLevel.load(std::memory_order_relaxed) ? LOG_OVERFLOW_DROP_NEWEST : LOG_OVERFLOW_BLOCK;
+        }
+        if (policy == LOG_OVERFLOW_DROP_NEWEST) {
+            dropped[level].fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        while ((slot = logQueue->tryAcquire(pos)) == nullptr) {
+            if (policy == LOG_OVERFLOW_DROP_OLDEST) {   // 从队头取走最旧的一条丢弃
+                size_t oldPos;
+                LogMessage* oldest = logQueue->tryConsume(oldPos);
+                if (oldest != nullptr) {
+                    enqueued[oldest->level].fetch_add(1, std::memory_order_relaxed);
+                    dropped[oldest->level].fetch_add(1, std::memory_order_relaxed);
+                    releaseData(*oldest);
+                    logQueue->release(oldPos);
+                    continue;
+                }
+            }
+            if (!running.load(std::memory_order_relaxed)) {    // 已停止, 不再等待日志线程
+                dropped[level].fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            std::this_thread::yield();
+        }
+        return slot;
+    }
+    // 线程私有队列满时的处理: 生产者不能从队头取走日志, LOG_OVERFLOW_DROP_OLDEST 按丢弃最新处理
+    inline LogMessage* acquireLocalSlot(LogSpscRing<LogMessage>& ring, LogLevel level)
+    {
+        LogMessage* slot = ring.tryAcquire();
+        if (slot != nullptr) return slot;
+        int policy = overflowPolicy.load(std::memory_order_relaxed);
+        if (policy == LOG_OVERFLOW_DROP_BELOW_LEVEL) {
+            policy = level < overflowLevel.load(std::memory_order_relaxed) ? LOG_OVERFLOW_DROP_NEWEST : LOG_OVERFLOW_BLOCK;
+        }
+        while (policy == LOG_OVERFLOW_BLOCK && running.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+            if ((slot = ring.tryAcquire()) != nullptr) return slot;
+        }
+        dropped[level].fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    inline void formatDeferred(const LogMessage& msg, std::string& out) // 格式化延迟日志(日志线程调用, 复用输出缓冲区)
+    {
+        if (out.capacity() < 256) out.reserve(256);
+        out.resize(out.capacity());
+        const char* file = my_basename(msg.site->file);
+        int size = msg.schema->format(&out[0], out.size() + 1, msg.site->fmt, msg.data(), file, msg.site->line);
+        if (size < 0) size = 0;
+        if (static_cast<size_t>(size) > out.size()) {   // 缓冲区不足时扩容后重新格式化
+            out.resize(size);
+            msg.schema->format(&out[0], out.size() + 1, msg.site->fmt, msg.data(), file, msg.site->line);
+        }
+        out.resize(size);
     }
     inline bool checkConfigFileChange()  // 检查日志配置文件是否有变化
     {
@@ -355,9 +1854,11 @@ protected:
 #endif
         return false;
     }
-    inline void loadConfig()  // 加载日志配置文件
+    // 加载日志配置文件: 解析到新的配置快照, 解析完成后整体替换(读取方不会看到解析到一半的配置)
+    inline void loadConfig()
     {
-        log_map.clear();
+        std::shared_ptr<LogConfigSnapshot> snapshot = std::make_shared<LogConfigSnapshot>();
+        std::map<std::string, std::string>& log_map = snapshot->values;
         std::ifstream configFile(logConfigFile);
         if (configFile.is_open()) {
             std::string line;
@@ -370,75 +1871,208 @@ protected:
                     continue;
                 }
                 auto result = splitByEqual(line);    // 按"="拆分配置项
-                if(result.first.empty() || result.second.empty()) continue;
+                if(result.first.empty()) continue;
+                if(result.second.empty()) {     // 缺少值的配置项只跳过这一项
+                    std::cerr << "Invalid value in " << logConfigFile << ": " << result.first << "=" << '\n';
+                    continue;
+                }
                 log_map.insert(std::pair<std::string, std::string>(result.first, result.second));
             }
             configFile.close();
             // 更新配置
             try {
                 std::lock_guard<std::mutex> lock(configMtx); // 加锁，防止多线程同时修改配置
-                int _logLevel = std::stoi(log_map["log_level"].c_str());
-                if(_logLevel >= LV_TRACE && _logLevel <= LV_CLOSE) {
-                    this->logLevel = static_cast<LogLevel>(_logLevel);
-                    // log(LV_CLOSE, "日志输出级别变更为: %s", LogLevelNames[_logLevel].c_str()); // 记录日志级别变更日志
+                for (std::map<std::string, std::string>::const_iterator it = log_map.begin(); it != log_map.end(); ++it) {
+                    bool file = it->first.compare(0, 11, "level.file:") == 0;
+                    if (!file && it->first.compare(0, 6, "level.") != 0) continue;
+                    int level = parseLevel(it->second);
+                    if (level < 0) {    // 无效的级别只跳过这一项, 不影响其他配置
+                        std::cerr << "Invalid log level in " << logConfigFile << ": " << it->first << "=" << it->second << '\n';
+                        continue;
+                    }
+                    if (file) snapshot->fileLevels[it->first.substr(11)] = level;
+                    else snapshot->moduleLevels[it->first.substr(6)] = level;
+                }
+                std::atomic_store(&config, std::shared_ptr<const LogConfigSnapshot>(snapshot));  // 调用点级别在下面 updateEnabledLevel 时重新计算
+                // 数值和级别配置项逐项解析, 无效的值只跳过该项并提示, 不影响其他配置
+                int level = 0;
+                uint64_t number = 0;
+                if (configLevel(log_map, "log_level", level)) {
+                    this->logLevel.store(level, std::memory_order_relaxed);
+                    // log(LV_CLOSE, "日志输出级别变更为: %s", LogLevelNames[level].c_str()); // 记录日志级别变更日志
+                }
+                if (configLevel(log_map, "console_level", level)) this->consoleLevel.store(level, std::memory_order_relaxed);
+                updateEnabledLevel();
+                if (log_map.count("console_color")) {
+                    const std::string& color = log_map["console_color"];
+                    this->consoleColor.store(color == "on" ? 1 : (color == "off" ? 0 : -1), std::memory_order_relaxed);
+                }
+                if (log_map.count("time_precision")) {
+                    int precision = parseTimePrecision(log_map["time_precision"]);
+                    if (precision >= 0) this->timePrecision.store(precision, std::memory_order_relaxed);
+                }
+                LogFlushPolicy policy = flushPolicy;
+                if (log_map.count("flush_policy")) {
+                    int mode = parseFlushMode(log_map["flush_policy"]);
+                    if (mode >= 0) policy.mode = static_cast<LogFlushMode>(mode);
+                }
+                if (configNumber(log_map, "flush_bytes", number, SIZE_MAX)) policy.bytes = static_cast<size_t>(number);
+                if (configNumber(log_map, "flush_interval_ms", number, INT_MAX)) policy.intervalMs = static_cast<int>(number);
+                if (configLevel(log_map, "flush_level", level)) policy.level = level;
+                flushPolicy = policy;
+                if (log_map.count("file_sink")) {
+                    const std::string& value = log_map["file_sink"];
+                    if (value == "write") fileSink = LOG_SINK_WRITE;
+                    else if (value == "mmap") fileSink = LOG_SINK_MMAP;
+                }
+                if (log_map.count("file_format")) {
+                    const std::string& value = log_map["file_format"];
+                    if (value == "text") fileFormat = LOG_FORMAT_TEXT;
+                    else if (value == "binary") fileFormat = LOG_FORMAT_BINARY;
+                }
+                if (log_map.count("stream_compress")) streamCompress = log_map["stream_compress"] == "on" || log_map["stream_compress"] == "1";
+                if (configNumber(log_map, "index_interval", number, UINT64_MAX, true)) indexInterval = number;
+                if (log_map.count("transport")) transport = log_map["transport"] == "shm" ? LOG_TRANSPORT_SHM : LOG_TRANSPORT_FILE;  // 下次 start 时生效
+                if (configNumber(log_map, "shm_size", number, SIZE_MAX, true)) shmSize = static_cast<size_t>(number);
+                if (configNumber(log_map, "queue_capacity", number, SIZE_MAX)) queueCapacity = static_cast<size_t>(number);  // 下次 start 时生效
+                if (log_map.count("queue_mode")) {
+                    const std::string& value = log_map["queue_mode"];
+                    if (value == "shared") queueMode.store(LOG_QUEUE_SHARED, std::memory_order_relaxed);
+                    else if (value == "per_thread") queueMode.store(LOG_QUEUE_PER_THREAD, std::memory_order_relaxed);
+                }
+                if (configNumber(log_map, "thread_queue_capacity", number, SIZE_MAX)) threadQueueCapacity.store(static_cast<size_t>(number), std::memory_order_relaxed);
+                if (log_map.count("overflow_policy")) {
+                    const std::string& value = log_map["overflow_policy"];
+                    if (value == "block") overflowPolicy.store(LOG_OVERFLOW_BLOCK, std::memory_order_relaxed);
+                    else if (value == "drop_newest") overflowPolicy.store(LOG_OVERFLOW_DROP_NEWEST, std::memory_order_relaxed);
+                    else if (value == "drop_oldest") overflowPolicy.store(LOG_OVERFLOW_DROP_OLDEST, std::memory_order_relaxed);
+                    else if (value == "drop_below_level") overflowPolicy.store(LOG_OVERFLOW_DROP_BELOW_LEVEL, std::memory_order_relaxed);
+                }
+                if (configLevel(log_map, "overflow_level", level)) overflowLevel.store(level, std::memory_order_relaxed);
+                if (configNumber(log_map, "drop_report_interval_ms", number, INT_MAX)) dropReportIntervalMs = static_cast<int>(number);
+                if (log_map.count("crash_handler") && (log_map["crash_handler"] == "on" || log_map["crash_handler"] == "1")) {
+                    installCrashHandler();
+                }
+                if (log_map.count("consumer_wait")) setConsumerWait(log_map["consumer_wait"] == "poll" ? LOG_WAIT_POLL : LOG_WAIT_ADAPTIVE);
+                bool flightEntries = configNumber(log_map, "flight_recorder", number, SIZE_MAX);
+                bool flightLevelSet = configLevel(log_map, "flight_level", level);
+                if (flightEntries || flightLevelSet) {
+                    size_t entries = flightEntries ? static_cast<size_t>(number) : flightCapacity.load(std::memory_order_relaxed);
+                    if (!flightLevelSet) level = flightLevel.load(std::memory_order_relaxed);
+                    setFlightRecorder(entries, static_cast<LogLevel>(level));
                 }
+                if (configLevel(log_map, "flight_dump_level", level)) flightDumpLevel.store(level, std::memory_order_relaxed);
+                if (log_map.count("flight_signal") && (log_map["flight_signal"] == "on" || log_map["flight_signal"] == "1")) {
+                    installFlightSignal();
+                }
+                if (configNumber(log_map, "stats_interval_ms", number, INT_MAX)) statsIntervalMs.store(static_cast<int>(number), std::memory_order_relaxed);
+                LogRotationPolicy rotate = rotationPolicy;
+                if (configNumber(log_map, "max_file_size", number, UINT64_MAX, true)) rotate.maxFileSize = number;
+                if (configNumber(log_map, "max_files", number, SIZE_MAX)) rotate.maxFiles = static_cast<size_t>(number);
+                if (configNumber(log_map, "max_total_size", number, UINT64_MAX, true)) rotate.maxTotalSize = number;
+                if (log_map.count("compress")) rotate.compress = log_map["compress"] == "on" || log_map["compress"] == "1";
+                rotationPolicy = rotate;
+                writerConfigChanged.store(true, std::memory_order_release);
+                waiter.wake();
             }
             catch(const std::exception& e) {
                 std::cerr << e.what() << '\n';
             }            
         }
     }
-    inline std::string getCurrentLogFileName()  // 获取当前日志文件名
+    inline int parseFlushMode(const std::string& value)  // 解析刷盘策略
     {
-#if defined(_WIN32) || defined(_WIN64)
-        return logDir + "\\" + logModuleName + "." + getDate() + ".log";
-#else
-        return logDir + "/" + logModuleName + "." + getDate() + ".log";
-#endif
+        if (value == "batch") return LOG_FLUSH_BATCH;
+        if (value == "message") return LOG_FLUSH_MESSAGE;
+        if (value == "bytes") return LOG_FLUSH_BYTES;
+        if (value == "interval") return LOG_FLUSH_INTERVAL;
+        if (value == "level") return LOG_FLUSH_LEVEL;
+        return -1;
     }
-    inline std::string getDate()   // 获取当前日期
+    // 解析非负整数, suffix 为 true 时允许 K/M/G 后缀; 含其他字符、超出 max 时返回 false
+    inline bool parseNumber(const std::string& value, uint64_t max, bool suffix, uint64_t& out)
     {
-#if defined(_WIN32) || defined(_WIN64)
-        std::time_t now = std::time(nullptr);
-        std::tm* localTime = std::localtime(&now);
-        char buffer[16] = {0};
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", localTime);
-        return std::string(buffer);
-#else
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        // std::stringstream ss;
-        // ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d");
-        // return ss.str();
-        // C++11兼容版本
-        std::tm tm_snapshot;
-        localtime_r(&in_time_t, &tm_snapshot); // 线程安全版本
-        char buffer[16] = {0};
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm_snapshot);
-        return std::string(buffer);
-#endif
+        size_t idx = 0;
+        uint64_t number = 0;
+        for (; idx < value.size() && value[idx] >= '0' && value[idx] <= '9'; ++idx) {
+            unsigned digit = value[idx] - '0';
+            if (number > (UINT64_MAX - digit) / 10) return false;
+            number = number * 10 + digit;
+        }
+        if (idx == 0) return false;
+        if (suffix && idx + 1 == value.size()) {
+            int shift = 0;
+            switch (std::toupper(static_cast<unsigned char>(value[idx]))) {
+                case 'K': shift = 10; break;
+                case 'M': shift = 20; break;
+                case 'G': shift = 30; break;
+                default: return false;
+            }
+            if (number > (UINT64_MAX >> shift)) return false;
+            number <<= shift;
+            ++idx;
+        }
+        if (idx != value.size() || number > max) return false;
+        out = number;
+        return true;
     }
-    inline std::string getDateTime() // 获取当前日期和时间
+    // 读取数值配置项: 存在且有效时写入 out 并返回 true, 无效时提示并跳过该项
+    inline bool configNumber(const std::map<std::string, std::string>& values, const char* key, uint64_t& out, uint64_t max, bool suffix = false)
+    {
+        std::map<std::string, std::string>::const_iterator it = values.find(key);
+        if (it == values.end()) return false;
+        if (parseNumber(it->second, max, suffix, out)) return true;
+        std::cerr << "Invalid value in " << logConfigFile << ": " << key << "=" << it->second << '\n';
+        return false;
+    }
+    // 读取级别配置项: 存在且有效时写入 out 并返回 true, 无效时提示并跳过该项
+    inline bool configLevel(const std::map<std::string, std::string>& values, const char* key, int& out)
+    {
+        std::map<std::string, std::string>::const_iterator it = values.find(key);
+        if (it == values.end()) return false;
+        int level = parseLevel(it->second);
+        if (level >= 0) {
+            out = level;
+            return true;
+        }
+        std::cerr << "Invalid log level in " << logConfigFile << ": " << key << "=" << it->second << '\n';
+        return false;
+    }
+    inline int parseLevel(const std::string& value)  // 解析日志级别: 0-6 或 trace/debug/info/warn/error/fatal/close(不区分大小写), 无效时返回 -1
+    {
+        static const char* const names[] = { "trace", "debug", "info", "warn", "error", "fatal", "close" };
+        if (value.size() == 1 && value[0] >= '0' && value[0] <= '0' + LV_CLOSE) return value[0] - '0';
+        std::string lower(value);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        for (int i = LV_TRACE; i <= LV_CLOSE; ++i) {
+            if (lower == names[i]) return i;
+        }
+        return -1;
+    }
+    inline int parseTimePrecision(const std::string& value)  // 解析时间戳精度: s/ms/us/ns 或 0-3
+    {
+        if (value == "s" || value == "0") return LOG_TIME_SEC;
+        if (value == "ms" || value == "1") return LOG_TIME_MS;
+        if (value == "us" || value == "2") return LOG_TIME_US;
+        if (value == "ns" || value == "3") return LOG_TIME_NS;
+        return -1;
+    }
+    inline std::string getCurrentLogFileName()  // 获取当前日志文件名
     {
 #if defined(_WIN32) || defined(_WIN64)
-        std::time_t now = std::time(nullptr);
-        std::tm* localTime = std::localtime(&now);
-        char buffer[80];
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localTime);
-        return std::string(buffer);
+        const char* sep = "\\";
 #else
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        // std::stringstream ss;
-        // ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-        // return ss.str();
-        // C++11兼容版本
-        std::tm tm_snapshot;
-        localtime_r(&in_time_t, &tm_snapshot); // 线程安全版本
-        char buffer[20] = {0};  // 扩大缓冲区大小
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm_snapshot); // 添加时间格式
-        return std::string(buffer);
+        const char* sep = "/";
 #endif
+        // <module>.<date>.log, 按大小切换后为 <module>.<date>.<index>.log; 二进制格式扩展名为 .blog, 流式压缩时再加 .gz
+        std::string ext = binaryFile ? ".blog" : ".log";
+        if (compressedFile) ext += ".gz";
+        if (logFileIndex == 0) return logDir + sep + logModuleName + "." + logCreateDate + ext;
+        return logDir + sep + logModuleName + "." + logCreateDate + "." + std::to_string(logFileIndex) + ext;
+    }
+    inline std::string getDate()   // 获取当前日期
+    {
+        return LogTimeFormatter::date(LogClock::nowNanos());
     }
     inline std::pair<std::string, std::string> splitByEqual(const std::string& str) {
         size_t pos = str.find('=');
@@ -452,44 +2086,267 @@ protected:
 private:
     inline static Logger* instance = nullptr;    // 单例实例指针(需要gcc4.8以上版本支持)
 
-#if defined(_WIN32) || defined(_WIN64)
-    HANDLE logFileHandle;  // 日志文件句柄
-#else
-    std::ofstream logfp{nullptr};       // 日志文件流
-#endif
+    LogFileWriter fileWriter;           // 日志文件批量写入器(仅日志线程使用)
+    LogFlushPolicy flushPolicy;         // 刷盘策略(configMtx 保护)
+    LogFileSink fileSink = LOG_SINK_WRITE;  // 日志文件输出方式(configMtx 保护)
+    LogFileFormat fileFormat = LOG_FORMAT_TEXT; // 日志文件格式(configMtx 保护)
+    bool binaryFile = false;            // 当前日志文件是否为二进制格式(仅日志线程使用)
+    bool streamCompress = false;        // 是否流式压缩(configMtx 保护)
+    bool compressedFile = false;        // 当前日志文件是否流式压缩(仅日志线程使用)
+    LogBinaryEncoder binaryEncoder;     // 二进制格式编码器(仅日志线程使用)
+    uint64_t indexInterval = 0;         // 索引块大小, 0 表示不生成索引(configMtx 保护)
+    uint64_t indexBlockSize = 0;        // 日志线程当前使用的索引块大小
+    LogIndexWriter indexWriter;         // 索引文件写入器(仅日志线程使用)
+    LogRotationPolicy rotationPolicy;   // 切换/保留策略(configMtx 保护)
+    std::atomic<bool> writerConfigChanged{false};   // 刷盘/切换策略是否待生效
+    LogRotationPolicy rotation;         // 日志线程当前使用的切换/保留策略
+    int logFileIndex = 0;               // 当天日志文件序号
+    LogArchiver archiver;               // 归档线程(压缩与清理)
     std::mutex configMtx;               // 配置变量互斥锁
-    std::mutex logQueueMtx;             // 日志队列互斥锁
-    std::queue<LogMessage> logQueue;    // 日志队列
+    std::unique_ptr<LogRingBuffer<LogMessage>> logQueue;   // 日志队列(无锁多生产者单消费者环形队列)
+    size_t queueCapacity;               // 日志队列容量
+    std::atomic<int> queueMode{LOG_QUEUE_SHARED};          // 队列模式
+    std::atomic<size_t> threadQueueCapacity{LOG_THREAD_QUEUE_CAPACITY};    // 线程私有队列容量
+    std::atomic<LogThreadBuffer*> threadBuffers[LOG_MAX_THREAD_BUFFERS] = {};   // 线程私有队列登记表(无锁, 崩溃转储时也可遍历)
+    std::atomic<size_t> threadBufferSlots{0};              // 登记表已使用的最大下标 + 1
+    std::atomic<size_t> flightCapacity{0};      // 飞行记录器每个线程的条数, 0 表示关闭
+    std::atomic<int> flightLevel{LV_TRACE};     // 飞行记录器记录的最低级别
+    std::atomic<int> flightDumpLevel{LV_ERROR}; // 触发转储的级别
+    std::atomic<bool> flightDumpRequested{false};   // 是否有转储请求(API 或 SIGUSR1)
+    std::atomic<LogFlightRing*> flightRings[LOG_MAX_THREAD_BUFFERS] = {};  // 飞行记录器登记表
+    std::atomic<size_t> flightRingSlots{0};     // 登记表已使用的最大下标 + 1
+    std::vector<LogMessage> flightDump;         // 转储时收集的日志(仅日志线程使用)
+    std::atomic<size_t> threadQueueDepth{0};               // 线程私有队列中的日志数(日志线程每批采样)
+    std::atomic<size_t> threadQueueCount{0};               // 已登记的线程私有队列数
+    std::vector<LogMergeEntry> mergeHeap;                  // 归并堆(仅日志线程使用)
+    LogSpillPool spillPool;             // 超长日志的溢出块池
+    LogProducerCount producers;         // 正在写入队列/共享内存的调用方线程数
+    std::atomic<int> overflowPolicy{LOG_OVERFLOW_BLOCK};   // 队列满时的处理策略
+    std::atomic<int> overflowLevel{LV_WARN};               // LOG_OVERFLOW_DROP_BELOW_LEVEL 的级别阈值
+    std::atomic<uint64_t> dropped[LV_CLOSE + 1] = {};      // 各级别被丢弃的日志数
+    uint64_t droppedReported = 0;       // 已写入日志的丢弃总数(仅日志线程使用)
+    int64_t lastDropReportNanos = 0;    // 上次写入丢弃统计的时间
+    std::atomic<int> dropReportIntervalMs{1000};           // 丢弃统计写入日志的最小间隔
+    std::atomic<uint64_t> enqueued[LV_CLOSE + 1] = {};     // 各级别已出队的日志数(日志线程计数, 不在调用方热路径上)
+    std::atomic<uint64_t> written[LV_CLOSE + 1] = {};      // 各级别已写入输出端的日志数
+    std::atomic<size_t> queueHighWater{0};                 // 队列深度峰值
+    LogHistogram enqueueLatency;        // 入队到写入缓冲区的延迟(仅日志线程写)
+    std::atomic<int> statsIntervalMs{0};                   // 统计信息写入日志的周期, 0 表示不写
+    int64_t lastStatsNanos = 0;         // 上次写入统计信息的时间
+    std::mutex flushMtx;                // flush 等待互斥锁(不在日志热路径上)
+    std::condition_variable flushCv;    // flush 完成通知
+    std::atomic<uint64_t> flushRequests{0};     // flush 请求计数
+    std::atomic<uint64_t> flushedRequest{0};    // 日志线程已应答的请求计数
+    std::atomic<size_t> flushedPos{0};  // 已写出(write 返回)的队列位置
+    std::atomic<bool> crashHandlerEnabled{false};   // 是否已安装崩溃处理
+    std::atomic<bool> crashing{false};          // 崩溃转储进行中
+    std::atomic<bool> consumerParked{false};    // 日志线程已为崩溃转储停下
+    LogWaiter waiter;                   // 日志线程空闲等待与唤醒
+    std::atomic<int> waitMode{LOG_WAIT_ADAPTIVE};   // 日志线程等待方式
+    LogConfigWatcher configWatcher;     // 配置文件监视(inotify)
+    LogShmWriter shmRing;               // 共享内存环形队列(共享内存传输时打开)
+    LogTransport transport = LOG_TRANSPORT_FILE;    // 日志输出方式(start 时生效)
+    size_t shmSize = LOG_SHM_SIZE;      // 共享内存段大小
     std::thread logThread;              // 日志线程成员变量
     std::thread timerThread;            // 定时器线程成员变量
-    std::condition_variable cv;         // 条件变量(日志队列)用于线程同步
-    std::map<std::string, std::string> log_map;     // 配置检查信息
+    std::shared_ptr<const LogConfigSnapshot> config = std::make_shared<LogConfigSnapshot>();   // 配置快照(std::atomic_load/atomic_store 读写)
+    std::mutex siteMtx;                 // 调用点登记和命名日志器表
+    LogSiteLevel* sites = nullptr;      // 已登记的调用点级别缓存(siteMtx)
+    std::map<std::string, std::unique_ptr<LogModule>> modules;  // 命名日志器(siteMtx)
+    std::string deferredText;           // 延迟格式化输出缓冲区(仅日志线程使用)
+    LogTimeFormatter timeFormatter;     // 日志文件时间戳格式化(仅日志线程使用)
+    LogFileWriter consoleWriter;        // 终端批量写入器(仅日志线程使用)
+    LogTimeFormatter consoleFormatter;  // 终端时间戳格式化(仅日志线程使用)
+    bool consoleIsTerminal = false;     // 标准输出是否为终端
 };
 
-inline static const char* my_basename(const char* path) {
-#if defined(_WIN32) || defined(_WIN64)
-    const char* base = strrchr(path, '\\');
-    return base? base+1 : path;
+// 定义一个通用的日志宏
+// 先做编译期级别判断(常量折叠), 再读一次调用点的级别缓存(按模块/源文件配置解析), 被过滤的日志不格式化、不取时间
+// module 为命名日志器指针(LogModule*), 普通日志为 nullptr; 同一调用点始终使用首次输出时的日志器
+#define LOG_EAGER_AT(module, level, fmt, ...) \
+    do { \
+        if ((level) >= LOGGER_COMPILE_MIN_LEVEL) { \
+            static LogSiteLevel logSiteLevel(__FILE__); \
+            Logger* logger = Logger::logInstance(); \
+            int logSiteLevels; \
+            if (logger && logger->isEnabled(level, logSiteLevel, module, logSiteLevels)) { \
+                logger->logAt(logSiteLevels, level, "[%s:%d] " fmt, __FILENAME__, __LINE__, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+#define LOG_EAGER(level, fmt, ...) LOG_EAGER_AT(nullptr, level, fmt, ##__VA_ARGS__)
+// 延迟格式化日志宏: 调用点静态记录格式串, 只拷贝参数原始字节
+#define LOG_DEFERRED_AT(module, level, fmt, ...) \
+    do { \
+        if ((level) >= LOGGER_COMPILE_MIN_LEVEL) { \
+            static LogSiteLevel logSiteLevel(__FILE__); \
+            Logger* logger = Logger::logInstance(); \
+            int logSiteLevels; \
+            if (logger && logger->isEnabled(level, logSiteLevel, module, logSiteLevels)) { \
+                static const LogCallSite logCallSite = { __FILE__, __LINE__, "[%s:%d] " fmt }; \
+                if (0) logFormatCheck("[%s:%d] " fmt, "", 0, ##__VA_ARGS__); \
+                logger->logDeferredAt(logSiteLevels, level, &logCallSite, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+#define LOG_DEFERRED(level, fmt, ...) LOG_DEFERRED_AT(nullptr, level, fmt, ##__VA_ARGS__)
+#if LOGGER_DEFERRED_FORMAT
+#define LOG_AT(module, level, fmt, ...) LOG_DEFERRED_AT(module, level, fmt, ##__VA_ARGS__)
 #else
-    const char* base = strrchr(path, '/');
-    return base? base+1 : path;
+#define LOG_AT(module, level, fmt, ...) LOG_EAGER_AT(module, level, fmt, ##__VA_ARGS__)
 #endif
-}
-#define __FILENAME__ my_basename(__FILE__)
-// 定义一个通用的日志宏
-#define LOG(level, fmt, ...) \
+#define LOG(level, fmt, ...) LOG_AT(nullptr, level, fmt, ##__VA_ARGS__)
+#define LOG_DISABLED(fmt, ...) do {} while (0)
+// 命名日志器宏: module 为 Logger::getModule 返回的 LogModule&, 级别按 level.<模块名> 配置, 内容前带 "[模块名] "
+#define MLOG(module, level, fmt, ...) LOG_AT(&(module), level, "[%s] " fmt, (module).c_str(), ##__VA_ARGS__)
+#define MLOG_DISABLED(module, fmt, ...) do {} while (0)
+// 限流日志宏写入一条日志: note 为抑制计数, 写在调用点位置之后、内容之前
+#if LOGGER_DEFERRED_FORMAT
+#define LOG_LIMITED_WRITE(logger, levels, level, note, fmt, ...) \
+    do { \
+        static const LogCallSite logCallSite = { __FILE__, __LINE__, "[%s:%d] %s" fmt }; \
+        if (0) logFormatCheck("[%s:%d] %s" fmt, "", 0, "", ##__VA_ARGS__); \
+        (logger)->logDeferredAt(levels, level, &logCallSite, note, ##__VA_ARGS__); \
+    } while (0)
+#else
+#define LOG_LIMITED_WRITE(logger, levels, level, note, fmt, ...) \
+    (logger)->logAt(levels, level, "[%s:%d] %s" fmt, __FILENAME__, __LINE__, note, ##__VA_ARGS__)
+#endif
+// 限流日志宏的公共部分: 先判断级别, 再查询调用点的静态限流状态, 被抑制的调用到此为止
+// 只进入飞行记录器的调用(低于输出级别)不查询限流状态, 不消耗限流额度
+// 抑制后再次输出时在内容前加上 "(suppressed N) ", N 为期间被抑制的条数
+#define LOG_LIMITED(level, limiter, check, fmt, ...) \
+    do { \
+        if ((level) >= LOGGER_COMPILE_MIN_LEVEL) { \
+            static LogSiteLevel logLimitedSite(__FILE__); \
+            Logger* logLimitedLogger = Logger::logInstance(); \
+            int logLimitedLevels; \
+            if (logLimitedLogger && logLimitedLogger->isEnabled(level, logLimitedSite, nullptr, logLimitedLevels)) { \
+                static limiter logLimiter; \
+                uint64_t logSuppressed = 0; \
+                if ((level) < logSiteOutput(logLimitedLevels) || logLimiter.allow check) { \
+                    char logNote[48]; \
+                    LOG_LIMITED_WRITE(logLimitedLogger, logLimitedLevels, level, \
+                                      logSuppressedNote(logNote, sizeof(logNote), logSuppressed), fmt, ##__VA_ARGS__); \
+                } \
+            } \
+        } \
+    } while (0)
+// 每 n 次输出一次
+#define LOG_EVERY_N(level, n, fmt, ...) LOG_LIMITED(level, LogEveryN, (n, logSuppressed), fmt, ##__VA_ARGS__)
+// 只输出前 n 次
+#define LOG_FIRST_N(level, n, fmt, ...) LOG_LIMITED(level, LogFirstN, (n, logSuppressed), fmt, ##__VA_ARGS__)
+// 每 ms 毫秒最多输出一次
+#define LOG_EVERY_MS(level, ms, fmt, ...) LOG_LIMITED(level, LogEveryMs, (ms, logSuppressed), fmt, ##__VA_ARGS__)
+// 令牌桶限流: 平均每秒 rate 条, 最多连续突发 burst 条
+#define LOG_RATE_LIMITED(level, rate, burst, fmt, ...) LOG_LIMITED(level, LogRateLimiter, (rate, burst, logSuppressed), fmt, ##__VA_ARGS__)
+// {} 格式化日志宏: 编译期检查占位符个数与参数类型, 调用方直接写入队列槽位
+#define LOGF(level, fmt, ...) \
     do { \
-        Logger* logger = Logger::getInstance(); \
-        if (logger) { \
-            logger->log(level, "[%s:%d] " fmt, __FILENAME__, __LINE__, ##__VA_ARGS__); \
+        LOGF_CHECK(fmt, ##__VA_ARGS__); \
+        if ((level) >= LOGGER_COMPILE_MIN_LEVEL) { \
+            static LogSiteLevel logSiteLevel(__FILE__); \
+            Logger* logger = Logger::logInstance(); \
+            int logSiteLevels; \
+            if (logger && logger->isEnabled(level, logSiteLevel, nullptr, logSiteLevels)) { \
+                logger->logFormatAt(logSiteLevels, level, __FILENAME__, __LINE__, fmt, ##__VA_ARGS__); \
+            } \
         } \
     } while (0)
+#define LOGF_DISABLED(fmt, ...) do { LOGF_CHECK(fmt, ##__VA_ARGS__); } while (0)
+// 命名日志器的具体级别宏
+#if LOGGER_COMPILE_MIN_LEVEL <= 0
+#define MLOG_TRACE(module, fmt, ...) MLOG(module, LV_TRACE, fmt, ##__VA_ARGS__)
+#else
+#define MLOG_TRACE(module, fmt, ...) MLOG_DISABLED(module, fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 1
+#define MLOG_DEBUG(module, fmt, ...) MLOG(module, LV_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define MLOG_DEBUG(module, fmt, ...) MLOG_DISABLED(module, fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 2
+#define MLOG_INFO(module, fmt, ...)  MLOG(module, LV_INFO, fmt, ##__VA_ARGS__)
+#else
+#define MLOG_INFO(module, fmt, ...)  MLOG_DISABLED(module, fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 3
+#define MLOG_WARN(module, fmt, ...)  MLOG(module, LV_WARN, fmt, ##__VA_ARGS__)
+#else
+#define MLOG_WARN(module, fmt, ...)  MLOG_DISABLED(module, fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 4
+#define MLOG_ERROR(module, fmt, ...) MLOG(module, LV_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define MLOG_ERROR(module, fmt, ...) MLOG_DISABLED(module, fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 5
+#define MLOG_FATAL(module, fmt, ...) MLOG(module, LV_FATAL, fmt, ##__VA_ARGS__)
+#else
+#define MLOG_FATAL(module, fmt, ...) MLOG_DISABLED(module, fmt, ##__VA_ARGS__)
+#endif
 // 使用通用日志宏定义具体的日志级别宏
+#if LOGGER_COMPILE_MIN_LEVEL <= 0
 #define LOG_TRACE(fmt, ...) LOG(LV_TRACE, fmt, ##__VA_ARGS__)
+#else
+#define LOG_TRACE(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 1
 #define LOG_DEBUG(fmt, ...) LOG(LV_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 2
 #define LOG_INFO(fmt, ...)  LOG(LV_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...)  LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 3
 #define LOG_WARN(fmt, ...)  LOG(LV_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...)  LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 4
 #define LOG_ERROR(fmt, ...) LOG(LV_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 5
 #define LOG_FATAL(fmt, ...) LOG(LV_FATAL, fmt, ##__VA_ARGS__)
+#else
+#define LOG_FATAL(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+// {} 格式化的具体级别宏, 被编译期最低级别关闭时仍做格式检查
+#if LOGGER_COMPILE_MIN_LEVEL <= 0
+#define LOGF_TRACE(fmt, ...) LOGF(LV_TRACE, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_TRACE(fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 1
+#define LOGF_DEBUG(fmt, ...) LOGF(LV_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_DEBUG(fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 2
+#define LOGF_INFO(fmt, ...)  LOGF(LV_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_INFO(fmt, ...)  LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 3
+#define LOGF_WARN(fmt, ...)  LOGF(LV_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_WARN(fmt, ...)  LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 4
+#define LOGF_ERROR(fmt, ...) LOGF(LV_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_ERROR(fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+#if LOGGER_COMPILE_MIN_LEVEL <= 5
+#define LOGF_FATAL(fmt, ...) LOGF(LV_FATAL, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_FATAL(fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
 
 #endif // LOGGER_H
\ No newline at end of file
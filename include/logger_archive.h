@@ -0,0 +1,243 @@
+#ifndef LOGGER_ARCHIVE_H
+#define LOGGER_ARCHIVE_H
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+#if defined(LOGGER_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+// 日志文件切换与保留策略
+struct LogRotationPolicy {
+    uint64_t maxFileSize = 0;   // 单个日志文件最大字节数, 0 表示只按日期切换
+    size_t maxFiles = 0;        // 最多保留的历史文件数(不含当前文件), 0 表示不限制
+    uint64_t maxTotalSize = 0;  // 历史文件总字节数上限, 0 表示不限制
+    bool compress = false;      // 是否 gzip 压缩已切换的文件(需要 LOGGER_HAVE_ZLIB)
+};
+
+// 日志归档线程: 在低优先级后台线程中压缩已切换的日志文件并清理过期文件
+// 日志线程和调用方线程只投递任务, 不会因压缩或删除文件而阻塞
+class LogArchiver {
+public:
+    LogArchiver(const LogArchiver&) = delete;
+    LogArchiver& operator=(const LogArchiver&) = delete;
+    LogArchiver() {}
+    ~LogArchiver() {
+        stop();
+    }
+
+    inline void start() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (worker.joinable()) return;
+        stopping = false;
+        worker = std::thread([this]() { run(); });
+    }
+    inline void stop() {   // 处理完已投递的任务后退出
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+    // 投递任务: rotated 为刚切换出的文件(可为空), active 为当前正在写的文件(清理时跳过)
+    inline void submit(const std::string& dir, const std::string& module, const std::string& rotated,
+                       const std::string& active, const LogRotationPolicy& policy) {
+        Task task;
+        task.dir = dir;
+        task.module = module;
+        task.rotated = rotated;
+        task.active = active;
+        task.policy = policy;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(task);
+        }
+        cv.notify_one();
+    }
+
+    static inline int64_t fileSize(const std::string& path) {   // 文件不存在返回 -1
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return -1;
+        return static_cast<int64_t>(st.st_size);
+    }
+
+private:
+    struct Task {
+        std::string dir;
+        std::string module;
+        std::string rotated;
+        std::string active;
+        LogRotationPolicy policy;
+    };
+    struct FileEntry {
+        std::string path;
+        int64_t size;
+        int64_t mtime;
+    };
+
+    inline void run() {
+        lowerPriority();
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;) {
+            cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) break;
+            Task task = tasks.front();
+            tasks.pop_front();
+            lock.unlock();
+            if (!task.rotated.empty() && task.policy.compress && !endsWith(task.rotated, ".gz")) compressFile(task.rotated);  // 流式压缩的文件已是 .gz
+            applyRetention(task);
+            lock.lock();
+        }
+    }
+
+    static inline void lowerPriority() {   // 降低 CPU 和 IO 优先级
+#if defined(_WIN32) || defined(_WIN64)
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#elif defined(__linux__)
+        pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        setpriority(PRIO_PROCESS, tid, 19);
+#if defined(SYS_ioprio_set)
+        syscall(SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, tid, 3 << 13 /* IOPRIO_CLASS_IDLE */);
+#endif
+#endif
+    }
+
+    static inline void compressFile(const std::string& path) {   // gzip 压缩为 path.gz 并删除原文件
+#if defined(LOGGER_HAVE_ZLIB)
+        std::FILE* in = std::fopen(path.c_str(), "rb");
+        if (in == nullptr) return;
+        std::string tmp = path + ".gz.tmp";
+        gzFile out = gzopen(tmp.c_str(), "wb6");
+        if (out == nullptr) {
+            std::fclose(in);
+            return;
+        }
+        std::vector<char> buffer(256 * 1024);
+        bool ok = true;
+        size_t n;
+        while ((n = std::fread(&buffer[0], 1, buffer.size(), in)) > 0) {
+            if (gzwrite(out, &buffer[0], static_cast<unsigned>(n)) != static_cast<int>(n)) {
+                ok = false;
+                break;
+            }
+        }
+        std::fclose(in);
+        if (gzclose(out) != Z_OK) ok = false;
+        if (ok && std::rename(tmp.c_str(), (path + ".gz").c_str()) == 0) {
+            std::remove(path.c_str());
+        } else {
+            std::remove(tmp.c_str());
+        }
+#else
+        (void)path;     // 未启用 zlib 时只做保留清理
+#endif
+    }
+
+    // 判断是否为本模块的日志文件: <module>.<date>[.<index>].log[.gz] 或 .blog[.gz](二进制格式)
+    static inline bool isModuleLogFile(const std::string& name, const std::string& module) {
+        if (name.size() <= module.size() + 1 || name.compare(0, module.size(), module) != 0) return false;
+        if (name[module.size()] != '.' || !std::isdigit(static_cast<unsigned char>(name[module.size() + 1]))) return false;
+        return endsWith(name, ".log") || endsWith(name, ".log.gz") || endsWith(name, ".blog") || endsWith(name, ".blog.gz");
+    }
+    // 日志文件对应的索引文件: 归档压缩后的文件沿用未压缩文件的索引(偏移为解压后的位置)
+    static inline std::string indexPath(const std::string& path) {
+        return (endsWith(path, ".gz") ? path.substr(0, path.size() - 3) : path) + ".idx";
+    }
+    static inline bool endsWith(const std::string& s, const char* suffix) {
+        size_t n = std::strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    static inline std::vector<FileEntry> listModuleFiles(const std::string& dir, const std::string& module) {
+        std::vector<FileEntry> files;
+#if defined(_WIN32) || defined(_WIN64)
+        WIN32_FIND_DATAA data;
+        HANDLE h = FindFirstFileA((dir + "\\*").c_str(), &data);
+        if (h == INVALID_HANDLE_VALUE) return files;
+        do {
+            std::string name = data.cFileName;
+            if (!isModuleLogFile(name, module)) continue;
+            FileEntry e;
+            e.path = dir + "\\" + name;
+            e.size = (static_cast<int64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            e.mtime = (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+            files.push_back(e);
+        } while (FindNextFileA(h, &data));
+        FindClose(h);
+#else
+        DIR* d = opendir(dir.c_str());
+        if (d == nullptr) return files;
+        struct dirent* ent;
+        while ((ent = readdir(d)) != nullptr) {
+            std::string name = ent->d_name;
+            if (!isModuleLogFile(name, module)) continue;
+            FileEntry e;
+            e.path = dir + "/" + name;
+            struct stat st;
+            if (stat(e.path.c_str(), &st) != 0) continue;
+            e.size = static_cast<int64_t>(st.st_size);
+#if defined(__linux__)
+            e.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+            e.mtime = static_cast<int64_t>(st.st_mtime);
+#endif
+            files.push_back(e);
+        }
+        closedir(d);
+#endif
+        return files;
+    }
+
+    // 按修改时间从旧到新删除历史文件, 直到满足数量和总大小限制
+    static inline void applyRetention(const Task& task) {
+        if (task.policy.maxFiles == 0 && task.policy.maxTotalSize == 0) return;
+        std::vector<FileEntry> files = listModuleFiles(task.dir, task.module);
+        files.erase(std::remove_if(files.begin(), files.end(), [&task](const FileEntry& e) {
+            return e.path == task.active;
+        }), files.end());
+        std::sort(files.begin(), files.end(), [](const FileEntry& a, const FileEntry& b) {
+            return a.mtime != b.mtime ? a.mtime < b.mtime : a.path < b.path;
+        });
+        uint64_t total = 0;
+        for (const FileEntry& e : files) total += e.size;
+        size_t count = files.size();
+        for (const FileEntry& e : files) {
+            bool tooMany = task.policy.maxFiles > 0 && count > task.policy.maxFiles;
+            bool tooLarge = task.policy.maxTotalSize > 0 && total > task.policy.maxTotalSize;
+            if (!tooMany && !tooLarge) break;
+            if (std::remove(e.path.c_str()) == 0) {
+                std::remove(indexPath(e.path).c_str());    // 同时删除索引文件
+                std::remove((e.path + ".idx").c_str());     // 流式压缩文件的帧索引
+                --count;
+                total -= e.size;
+            }
+        }
+    }
+
+    std::mutex mtx;                 // 任务队列互斥锁(不在日志热路径上)
+    std::condition_variable cv;     // 任务通知
+    std::deque<Task> tasks;         // 待处理任务
+    std::thread worker;             // 归档线程
+    bool stopping = false;          // 是否退出
+};
+
+#endif // LOGGER_ARCHIVE_H
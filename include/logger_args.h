@@ -0,0 +1,144 @@
+#ifndef LOGGER_ARGS_H
+#define LOGGER_ARGS_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+// 延迟格式化: 调用方只记录调用点(静态格式串)和参数的原始字节, 由后台线程完成 printf 格式化
+
+// 调用点信息(每个日志宏一个静态实例, 常量初始化, 无运行期开销)
+struct LogCallSite {
+    const char* file;   // 源文件(__FILE__)
+    int line;           // 行号
+    const char* fmt;    // 完整格式串, 以 "[%s:%d] " 开头
+};
+
+// 参数类别, 高4位为类别, 低4位为原始字节数
+enum LogArgKind {
+    LOG_ARG_SIGNED   = 0x10,    // 有符号整数
+    LOG_ARG_UNSIGNED = 0x20,    // 无符号整数
+    LOG_ARG_FLOAT    = 0x30,    // 浮点数
+    LOG_ARG_STRING   = 0x40,    // C字符串(按内容拷贝)
+    LOG_ARG_POINTER  = 0x50,    // 指针(按值拷贝)
+};
+
+// 根据格式串和参数原始字节格式化, 返回值同 snprintf
+typedef int (*LogFormatFn)(char* out, size_t size, const char* fmt, const char* args, const char* file, int line);
+
+// 参数描述(每种参数类型组合一个静态实例)
+struct LogArgSchema {
+    LogFormatFn format;     // 格式化函数
+    size_t count;           // 参数个数
+    const uint8_t* kinds;   // 参数类别(LogArgKind | 字节数)
+};
+
+template <typename T>
+struct LogIsCString {
+    static const bool value = std::is_same<T, const char*>::value || std::is_same<T, char*>::value;
+};
+
+template <typename T, typename Enable = void>
+struct LogArgCodec;     // 未特化的类型(如 std::string、对象)不能作为延迟格式化参数
+
+// 算术类型、枚举、非字符串指针: 按值拷贝
+template <typename T>
+struct LogArgCodec<T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+                                              (std::is_pointer<T>::value && !LogIsCString<T>::value)>::type> {
+    static_assert(sizeof(T) <= 8, "log argument wider than 8 bytes is not supported");
+    typedef T Stored;
+    static const uint8_t kind = (std::is_pointer<T>::value ? LOG_ARG_POINTER :
+                                 std::is_floating_point<T>::value ? LOG_ARG_FLOAT :
+                                 std::is_signed<T>::value ? LOG_ARG_SIGNED : LOG_ARG_UNSIGNED) | sizeof(T);
+    static inline size_t size(const T&) { return sizeof(T); }
+    static inline char* encode(char* p, const T& v) {
+        std::memcpy(p, &v, sizeof(T));
+        return p + sizeof(T);
+    }
+    static inline const char* decode(const char* p, T& v) {
+        std::memcpy(&v, p, sizeof(T));
+        return p + sizeof(T);
+    }
+};
+
+// C字符串: 拷贝 长度(uint32) + 内容 + '\0', 解码时直接指向缓冲区
+template <typename T>
+struct LogArgCodec<T, typename std::enable_if<LogIsCString<T>::value>::type> {
+    typedef const char* Stored;
+    static const uint8_t kind = LOG_ARG_STRING | sizeof(uint32_t);
+    static inline size_t size(const T& v) {
+        return sizeof(uint32_t) + (v ? std::strlen(v) : 6) + 1;
+    }
+    static inline char* encode(char* p, const T& v) {
+        const char* s = v ? v : "(null)";
+        uint32_t len = static_cast<uint32_t>(std::strlen(s));
+        std::memcpy(p, &len, sizeof(len));
+        std::memcpy(p + sizeof(len), s, len + 1);
+        return p + sizeof(len) + len + 1;
+    }
+    static inline const char* decode(const char* p, const char*& v) {
+        uint32_t len;
+        std::memcpy(&len, p, sizeof(len));
+        v = p + sizeof(len);
+        return p + sizeof(len) + len + 1;
+    }
+};
+
+// 参数按 const 引用传入, 数组退化为 const 指针, 其余去掉 cv 限定
+template <typename T>
+using LogArgDecay = typename std::decay<const T>::type;
+
+// 参数包编码/解码
+template <typename... Args>
+struct LogArgEncoder;
+
+template <>
+struct LogArgEncoder<> {
+    static inline size_t size() { return 0; }
+    static inline char* encode(char* p) { return p; }
+    template <typename... Decoded>
+    static inline int format(char* out, size_t size, const char* fmt, const char*, Decoded... decoded) {
+        return std::snprintf(out, size, fmt, decoded...);
+    }
+};
+
+template <typename T, typename... Rest>
+struct LogArgEncoder<T, Rest...> {
+    typedef LogArgCodec<T> Codec;
+    static inline size_t size(const T& v, const Rest&... rest) {
+        return Codec::size(v) + LogArgEncoder<Rest...>::size(rest...);
+    }
+    static inline char* encode(char* p, const T& v, const Rest&... rest) {
+        return LogArgEncoder<Rest...>::encode(Codec::encode(p, v), rest...);
+    }
+    template <typename... Decoded>
+    static inline int format(char* out, size_t size, const char* fmt, const char* p, Decoded... decoded) {
+        typename Codec::Stored v;
+        p = Codec::decode(p, v);
+        return LogArgEncoder<Rest...>::format(out, size, fmt, p, decoded..., v);
+    }
+};
+
+template <typename... Args>
+struct LogArgPack {
+    static inline int format(char* out, size_t size, const char* fmt, const char* args, const char* file, int line) {
+        return LogArgEncoder<Args...>::format(out, size, fmt, args, file, line);
+    }
+    static const uint8_t kinds[sizeof...(Args) + 1];
+    static const LogArgSchema schema;
+};
+
+template <typename... Args>
+const uint8_t LogArgPack<Args...>::kinds[sizeof...(Args) + 1] = { LogArgCodec<Args>::kind..., 0 };
+
+template <typename... Args>
+const LogArgSchema LogArgPack<Args...>::schema = { &LogArgPack<Args...>::format, sizeof...(Args), LogArgPack<Args...>::kinds };
+
+// 编译期 printf 格式检查(仅用于 if (0) 分支, 不会被调用)
+#if defined(__GNUC__)
+inline void logFormatCheck(const char*, ...) __attribute__((format(printf, 1, 2)));
+#endif
+inline void logFormatCheck(const char*, ...) {}
+
+#endif // LOGGER_ARGS_H
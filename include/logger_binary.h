@@ -0,0 +1,462 @@
+#ifndef LOGGER_BINARY_H
+#define LOGGER_BINARY_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "logger_args.h"
+
+// 二进制日志格式(文件扩展名 .blog): 记录流, 每条记录以 1 字节标记开头(高 4 位为类型, 低 4 位为级别)
+//   文件头   LOG_BIN_HEADER  "LOGB" 版本 基准时间(varint) 模块名
+//   调用点   LOG_BIN_SITE    编号 行号 参数类别 源文件 格式串(每个文件一份字典, 调用点首次出现时写入)
+//   延迟日志 LOG_BIN_EVENT   时间差 调用点编号 参数(整数 varint/zigzag, 浮点数原始字节, 字符串 长度+内容)
+//   文本日志 LOG_BIN_TEXT    时间差 长度 内容(即时格式化的日志和日志库自身的提示)
+// 时间差为相对上一条记录的纳秒数(zigzag varint); 文件头重置字典和时间基准, 同一文件重新打开时追加新的文件头
+// 字节 0 为填充(mmap 方式异常退出时未截断的部分), 解码时跳过
+enum LogBinaryRecord {
+    LOG_BIN_HEADER = 0x10,
+    LOG_BIN_SITE   = 0x20,
+    LOG_BIN_EVENT  = 0x30,
+    LOG_BIN_TEXT   = 0x40,
+};
+
+#define LOG_BIN_MAGIC "LOGB"
+#define LOG_BIN_VERSION 1
+
+inline char* logPutVarint(char* p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = static_cast<char>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<char>(v);
+    return p;
+}
+inline uint64_t logZigzag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+inline int64_t logUnzigzag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// 二进制编码器(仅日志线程使用): 维护当前文件的调用点字典和上一条记录的时间
+// 调用方先按 xxxBound 预留写缓冲区, 再调用对应的编码函数, 返回写入后的位置
+class LogBinaryEncoder {
+public:
+    inline size_t headerBound(const std::string& module) const { return 32 + module.size(); }
+    inline char* header(char* p, int64_t nanos, const std::string& module) {
+        sites.clear();
+        lastNanos = nanos;
+        *p++ = static_cast<char>(LOG_BIN_HEADER);
+        std::memcpy(p, LOG_BIN_MAGIC, 4);
+        p += 4;
+        *p++ = static_cast<char>(LOG_BIN_VERSION);
+        p = logPutVarint(p, static_cast<uint64_t>(nanos));
+        p = logPutVarint(p, module.size());
+        std::memcpy(p, module.data(), module.size());
+        return p + module.size();
+    }
+
+    // 延迟日志: 每个标量参数编码后不超过原始字节数的 2 倍, 字符串不超过 原始长度 + 1
+    inline size_t eventBound(const LogCallSite* site, const LogArgSchema* schema, size_t length) const {
+        size_t bound = 32 + 2 * length;
+        if (sites.find(site) == sites.end()) bound += siteBound(site, schema);
+        return bound;
+    }
+    // 不论调用点是否已在字典中都计入调用点记录(之后写入的文件头会清空字典)
+    static inline size_t eventMaxBound(const LogCallSite* site, const LogArgSchema* schema, size_t length) {
+        return 32 + 2 * length + siteBound(site, schema);
+    }
+    inline char* event(char* p, int level, int64_t nanos, const LogCallSite* site, const LogArgSchema* schema, const char* data) {
+        std::unordered_map<const LogCallSite*, uint32_t>::const_iterator it = sites.find(site);
+        uint32_t id;
+        if (it == sites.end()) {
+            id = static_cast<uint32_t>(sites.size());
+            sites.insert(std::make_pair(site, id));
+            p = siteRecord(p, id, site, schema);
+        } else {
+            id = it->second;
+        }
+        *p++ = static_cast<char>(LOG_BIN_EVENT | level);
+        p = delta(p, nanos);
+        p = logPutVarint(p, id);
+        for (size_t i = 0; i < schema->count; ++i) {
+            uint8_t kind = schema->kinds[i];
+            size_t size = kind & 0x0f;
+            switch (kind & 0xf0) {
+                case LOG_ARG_SIGNED:
+                    p = logPutVarint(p, logZigzag(readSigned(data, size)));
+                    break;
+                case LOG_ARG_UNSIGNED:
+                case LOG_ARG_POINTER:
+                    p = logPutVarint(p, readUnsigned(data, size));
+                    break;
+                case LOG_ARG_FLOAT:
+                    std::memcpy(p, data, size);
+                    p += size;
+                    break;
+                case LOG_ARG_STRING: {
+                    uint32_t len;
+                    std::memcpy(&len, data, sizeof(len));
+                    p = logPutVarint(p, len);
+                    std::memcpy(p, data + sizeof(len), len);
+                    p += len;
+                    size += len + 1;    // 长度 + 内容 + '\0'
+                    break;
+                }
+                default:
+                    break;
+            }
+            data += size;
+        }
+        return p;
+    }
+
+    static inline size_t textBound(size_t length) { return 24 + length; }
+    // 文本日志的记录头, 内容由调用方紧接着写入(崩溃转储分段写出时使用, 异步信号安全)
+    inline char* textHeader(char* p, int level, int64_t nanos, size_t length) {
+        *p++ = static_cast<char>(LOG_BIN_TEXT | level);
+        p = delta(p, nanos);
+        return logPutVarint(p, length);
+    }
+    inline char* text(char* p, int level, int64_t nanos, const char* text, size_t length) {
+        p = textHeader(p, level, nanos, length);
+        std::memcpy(p, text, length);
+        return p + length;
+    }
+
+private:
+    inline char* delta(char* p, int64_t nanos) {
+        p = logPutVarint(p, logZigzag(nanos - lastNanos));
+        lastNanos = nanos;
+        return p;
+    }
+    static inline char* putString(char* p, const char* s) {
+        size_t len = std::strlen(s);
+        p = logPutVarint(p, len);
+        std::memcpy(p, s, len);
+        return p + len;
+    }
+    static inline size_t siteBound(const LogCallSite* site, const LogArgSchema* schema) {
+        return 48 + schema->count + std::strlen(site->file) + std::strlen(site->fmt);
+    }
+    static inline char* siteRecord(char* p, uint32_t id, const LogCallSite* site, const LogArgSchema* schema) {
+        *p++ = static_cast<char>(LOG_BIN_SITE);
+        p = logPutVarint(p, id);
+        p = logPutVarint(p, static_cast<uint64_t>(site->line));
+        p = logPutVarint(p, schema->count);
+        std::memcpy(p, schema->kinds, schema->count);
+        p += schema->count;
+        p = putString(p, site->file);
+        return putString(p, site->fmt);
+    }
+    static inline int64_t readSigned(const char* data, size_t size) {
+        switch (size) {
+            case 1: { int8_t v; std::memcpy(&v, data, 1); return v; }
+            case 2: { int16_t v; std::memcpy(&v, data, 2); return v; }
+            case 4: { int32_t v; std::memcpy(&v, data, 4); return v; }
+            default: { int64_t v; std::memcpy(&v, data, 8); return v; }
+        }
+    }
+    static inline uint64_t readUnsigned(const char* data, size_t size) {
+        switch (size) {
+            case 1: { uint8_t v; std::memcpy(&v, data, 1); return v; }
+            case 2: { uint16_t v; std::memcpy(&v, data, 2); return v; }
+            case 4: { uint32_t v; std::memcpy(&v, data, 4); return v; }
+            default: { uint64_t v; std::memcpy(&v, data, 8); return v; }
+        }
+    }
+
+    std::unordered_map<const LogCallSite*, uint32_t> sites;    // 当前文件的调用点字典
+    int64_t lastNanos = 0;      // 上一条记录的时间
+};
+
+// 二进制日志解码器: next 逐条读取记录(只解析参数, 不格式化), format 把当前记录还原为文本内容
+// 文本内容与文本格式日志中 "[时间] [级别] " 之后的部分相同
+class LogBinaryReader {
+public:
+    LogBinaryReader(const char* data, size_t size) : p(data), end(data + size) {}
+
+    inline bool next() {
+        while (p < end) {
+            uint8_t tag = static_cast<uint8_t>(*p++);
+            if (tag == 0) continue;     // 填充
+            level = tag & 0x0f;
+            bool ok;
+            switch (tag & 0xf0) {
+                case LOG_BIN_HEADER: ok = readHeader(); break;
+                case LOG_BIN_SITE: ok = readSite(); break;
+                case LOG_BIN_EVENT: ok = readEvent(); if (ok) return true; break;
+                case LOG_BIN_TEXT: ok = readText(); if (ok) return true; break;
+                default: ok = false; break;
+            }
+            if (!ok) {  // 记录不完整(如写入中途崩溃)或数据损坏, 停止解码
+                corrupted = true;
+                p = end;
+            }
+        }
+        return false;
+    }
+    inline int currentLevel() const { return level; }
+    inline int64_t currentNanos() const { return nanos; }
+    inline const std::string& module() const { return moduleName; }
+    inline bool isCorrupted() const { return corrupted; }
+
+    // 把当前记录还原为文本(追加到 out)
+    inline void format(std::string& out) {
+        if (site == nullptr) {
+            out.append(textData, textLength);
+            return;
+        }
+        args.clear();   // 格式串以 "[%s:%d] " 开头, 依次补上源文件名和行号
+        Arg file;
+        file.kind = LOG_ARG_STRING;
+        file.s = baseName(site->file.c_str());
+        file.len = static_cast<uint32_t>(std::strlen(file.s));
+        args.push_back(file);
+        Arg line;
+        line.kind = LOG_ARG_SIGNED;
+        line.i = site->line;
+        args.push_back(line);
+        args.insert(args.end(), values.begin(), values.end());
+        formatPrintf(out, site->fmt.c_str(), args);
+    }
+
+private:
+    struct Site {
+        int line;
+        std::vector<uint8_t> kinds;
+        std::string file;
+        std::string fmt;
+    };
+    struct Arg {
+        uint8_t kind = 0;
+        int64_t i = 0;
+        uint64_t u = 0;
+        double d = 0;
+        const char* s = nullptr;
+        uint32_t len = 0;
+    };
+
+    inline bool getVarint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t b = static_cast<uint8_t>(*p++);
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) return true;
+        }
+        return false;
+    }
+    inline bool getBytes(const char*& s, uint64_t& len) {
+        if (!getVarint(len) || len > static_cast<uint64_t>(end - p)) return false;
+        s = p;
+        p += len;
+        return true;
+    }
+    inline bool getDelta() {
+        uint64_t v;
+        if (!getVarint(v)) return false;
+        nanos += logUnzigzag(v);
+        return true;
+    }
+    inline bool readHeader() {
+        uint64_t base, len;
+        const char* name;
+        if (end - p < 5 || std::memcmp(p, LOG_BIN_MAGIC, 4) != 0 || p[4] != LOG_BIN_VERSION) return false;
+        p += 5;
+        if (!getVarint(base) || !getBytes(name, len)) return false;
+        moduleName.assign(name, len);
+        nanos = static_cast<int64_t>(base);
+        sites.clear();
+        return true;
+    }
+    inline bool readSite() {
+        uint64_t id, line, count, len;
+        const char* s;
+        if (!getVarint(id) || !getVarint(line) || !getVarint(count) || count > static_cast<uint64_t>(end - p)) return false;
+        if (id != sites.size()) return false;
+        Site entry;
+        entry.line = static_cast<int>(line);
+        entry.kinds.assign(p, p + count);
+        p += count;
+        if (!getBytes(s, len)) return false;
+        entry.file.assign(s, len);
+        if (!getBytes(s, len)) return false;
+        entry.fmt.assign(s, len);
+        sites.push_back(entry);
+        return true;
+    }
+    inline bool readEvent() {
+        uint64_t id;
+        if (!getDelta() || !getVarint(id) || id >= sites.size()) return false;
+        site = &sites[id];
+        values.resize(site->kinds.size());
+        for (size_t i = 0; i < site->kinds.size(); ++i) {
+            Arg& a = values[i];
+            a.kind = site->kinds[i] & 0xf0;
+            size_t size = site->kinds[i] & 0x0f;
+            uint64_t v;
+            switch (a.kind) {
+                case LOG_ARG_SIGNED:
+                    if (!getVarint(v)) return false;
+                    a.i = logUnzigzag(v);
+                    break;
+                case LOG_ARG_UNSIGNED:
+                case LOG_ARG_POINTER:
+                    if (!getVarint(a.u)) return false;
+                    break;
+                case LOG_ARG_FLOAT:
+                    if (static_cast<size_t>(end - p) < size) return false;
+                    if (size == sizeof(float)) {
+                        float f;
+                        std::memcpy(&f, p, sizeof(f));
+                        a.d = f;
+                    } else {
+                        std::memcpy(&a.d, p, sizeof(a.d));
+                    }
+                    p += size;
+                    break;
+                case LOG_ARG_STRING:
+                    if (!getBytes(a.s, v)) return false;
+                    a.len = static_cast<uint32_t>(v);
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+    inline bool readText() {
+        uint64_t len;
+        if (!getDelta() || !getBytes(textData, len)) return false;
+        textLength = static_cast<size_t>(len);
+        site = nullptr;
+        return true;
+    }
+
+    static inline const char* baseName(const char* path) {
+        const char* slash = std::strrchr(path, '/');
+        const char* backslash = std::strrchr(path, '\\');
+        if (backslash > slash) slash = backslash;
+        return slash ? slash + 1 : path;
+    }
+    static inline long long asSigned(const Arg& a) {
+        return a.kind == LOG_ARG_SIGNED ? a.i : a.kind == LOG_ARG_FLOAT ? static_cast<long long>(a.d) : static_cast<long long>(a.u);
+    }
+    static inline unsigned long long asUnsigned(const Arg& a) {
+        return a.kind == LOG_ARG_SIGNED ? static_cast<unsigned long long>(a.i) : a.kind == LOG_ARG_FLOAT ? static_cast<unsigned long long>(a.d) : a.u;
+    }
+    static inline double asDouble(const Arg& a) {
+        return a.kind == LOG_ARG_FLOAT ? a.d : a.kind == LOG_ARG_SIGNED ? static_cast<double>(a.i) : static_cast<double>(a.u);
+    }
+    // 按 printf 格式串逐个说明符格式化: 长度修饰符统一替换为参数的实际宽度(整数 ll, 浮点数 double)
+    inline void formatPrintf(std::string& out, const char* fmt, const std::vector<Arg>& list) {
+        size_t next = 0;
+        while (*fmt) {
+            const char* percent = std::strchr(fmt, '%');
+            if (percent == nullptr) {
+                out.append(fmt);
+                return;
+            }
+            out.append(fmt, percent - fmt);
+            fmt = percent + 1;
+            if (*fmt == '%') {
+                out += '%';
+                ++fmt;
+                continue;
+            }
+            char spec[64];
+            size_t n = 0;
+            spec[n++] = '%';
+            while (*fmt && std::strchr("-+ #0'", *fmt) && n < 8) spec[n++] = *fmt++;
+            for (int part = 0; part < 2; ++part) {  // 宽度和精度, * 从参数中取
+                if (part == 1) {
+                    if (*fmt != '.') break;
+                    spec[n++] = *fmt++;
+                }
+                if (*fmt == '*') {
+                    ++fmt;
+                    long long v = next < list.size() ? asSigned(list[next++]) : 0;
+                    n += std::snprintf(spec + n, 24, "%lld", v);
+                } else {
+                    while (*fmt >= '0' && *fmt <= '9' && n < 40) spec[n++] = *fmt++;
+                }
+            }
+            while (*fmt && std::strchr("hlLqjzt", *fmt)) ++fmt;
+            char conv = *fmt;
+            if (conv == '\0') break;
+            ++fmt;
+            if (next >= list.size()) continue;  // 参数不足(不会出现在宏生成的调用点中)
+            const Arg& a = list[next++];
+            switch (conv) {
+                case 'd': case 'i':
+                    spec[n++] = 'l'; spec[n++] = 'l'; spec[n++] = conv; spec[n] = '\0';
+                    appendFormatted(out, spec, asSigned(a));
+                    break;
+                case 'u': case 'o': case 'x': case 'X':
+                    spec[n++] = 'l'; spec[n++] = 'l'; spec[n++] = conv; spec[n] = '\0';
+                    appendFormatted(out, spec, asUnsigned(a));
+                    break;
+                case 'c':
+                    spec[n++] = conv; spec[n] = '\0';
+                    appendFormatted(out, spec, static_cast<int>(asSigned(a)));
+                    break;
+                case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                    spec[n++] = conv; spec[n] = '\0';
+                    appendFormatted(out, spec, asDouble(a));
+                    break;
+                case 's':
+                    spec[n++] = conv; spec[n] = '\0';
+                    if (a.kind == LOG_ARG_STRING) {
+                        str.assign(a.s, a.len);
+                        if (n == 2) out.append(str);    // 无宽度/精度时直接拷贝
+                        else appendFormatted(out, spec, str.c_str());
+                    } else {
+                        out.append("(?)");
+                    }
+                    break;
+                case 'p':
+                    spec[n++] = conv; spec[n] = '\0';
+                    appendFormatted(out, spec, reinterpret_cast<void*>(static_cast<uintptr_t>(asUnsigned(a))));
+                    break;
+                default:    // %n 等不支持的说明符: 跳过
+                    break;
+            }
+        }
+    }
+    template <typename T>
+    static inline void appendFormatted(std::string& out, const char* spec, T value) {
+        char buffer[256];
+        int n = std::snprintf(buffer, sizeof(buffer), spec, value);
+        if (n < 0) return;
+        if (static_cast<size_t>(n) < sizeof(buffer)) {
+            out.append(buffer, n);
+            return;
+        }
+        size_t old = out.size();
+        out.resize(old + n + 1);
+        std::snprintf(&out[old], n + 1, spec, value);
+        out.resize(old + n);
+    }
+
+    const char* p;                  // 当前读取位置
+    const char* end;                // 数据末尾
+    std::vector<Site> sites;        // 当前文件头之后的调用点字典
+    std::string moduleName;         // 模块名
+    int level = 0;                  // 当前记录级别
+    int64_t nanos = 0;              // 当前记录时间(纪元纳秒)
+    const Site* site = nullptr;     // 当前延迟日志的调用点(文本日志为空)
+    std::vector<Arg> values;        // 当前延迟日志的参数
+    std::vector<Arg> args;          // 格式化用参数(含源文件名和行号)
+    const char* textData = nullptr; // 当前文本日志内容
+    size_t textLength = 0;
+    std::string str;                // 字符串参数临时缓冲区
+    bool corrupted = false;         // 是否遇到不完整或损坏的记录
+};
+
+#endif // LOGGER_BINARY_H
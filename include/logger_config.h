@@ -0,0 +1,56 @@
+#ifndef LOGGER_CONFIG_H
+#define LOGGER_CONFIG_H
+#include <atomic>
+#include <map>
+#include <string>
+
+// 配置快照: loadConfig 每次解析配置文件生成一个新快照, 整体原子替换, 读取方拿到的快照之后不再修改
+// level.<模块>=N 设置命名日志器(LogModule)的文件级别, level.file:<源文件名>=N 设置某个源文件的文件级别(优先于模块)
+struct LogConfigSnapshot {
+    std::map<std::string, std::string> values;      // 全部配置项
+    std::map<std::string, int> moduleLevels;        // 模块名 -> 文件级别
+    std::map<std::string, int> fileLevels;          // 源文件名(不含目录) -> 文件级别
+};
+
+// 调用点级别缓存的打包格式(一个 int, 一次原子读取)
+// 位 0~7: 调用方判断用的最低级别(含终端和飞行记录器); 位 8~15: 文件级别; 位 16~23: 输出级别(文件和终端中的最低级别);
+// 位 24: 已解析。未解析时为 0, 判断总能通过, 随后由 Logger::resolveSite 计算并登记
+#define LOG_SITE_RESOLVED (1 << 24)
+static inline int logSitePack(int enabled, int file, int output)
+{
+    return enabled | (file << 8) | (output << 16) | LOG_SITE_RESOLVED;
+}
+static inline int logSiteEnabled(int levels) { return levels & 0xff; }
+static inline int logSiteFile(int levels) { return (levels >> 8) & 0xff; }
+static inline int logSiteOutput(int levels) { return (levels >> 16) & 0xff; }
+
+class LogModule;
+
+// 调用点级别缓存: 每个日志宏调用点一个静态对象(常量初始化, 无构造锁)
+// 首次通过判断时登记到 Logger, 配置或级别变化时由 Logger 统一重新计算, 调用方热路径只读 levels
+struct LogSiteLevel {
+    constexpr explicit LogSiteLevel(const char* sourceFile) : file(sourceFile), levels(0), module(nullptr), next(nullptr) {}
+    const char* file;               // 源文件(__FILE__, 空表示不按源文件匹配)
+    std::atomic<int> levels;        // 打包的级别缓存
+    const LogModule* module;        // 所属命名日志器(登记时记录, 之后不变)
+    LogSiteLevel* next;             // 登记链表
+};
+
+// 命名日志器: 与全局 Logger 共用队列和日志线程, 按 level.<name> 单独设置文件级别
+// 通过 Logger::getModule(name) 取得(进程内不销毁); 日志用 MLOG_XXX(module, fmt, ...) 宏输出, 内容前带 "[name] "
+class LogModule {
+public:
+    LogModule(const LogModule&) = delete;
+    LogModule& operator=(const LogModule&) = delete;
+    explicit LogModule(const std::string& moduleName) : moduleName(moduleName), site(nullptr) {}
+
+    inline const std::string& name() const { return moduleName; }
+    inline const char* c_str() const { return moduleName.c_str(); }
+    inline LogSiteLevel& levelCache() { return site; }  // 模块自身的级别缓存(不按源文件匹配), 供 Logger::isEnabled(level, module) 使用
+
+private:
+    std::string moduleName;     // 模块名
+    LogSiteLevel site;          // 模块级别缓存
+};
+
+#endif // LOGGER_CONFIG_H
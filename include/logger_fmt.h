@@ -0,0 +1,254 @@
+#ifndef LOGGER_FMT_H
+#define LOGGER_FMT_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// 类型安全的 {} 格式化: LOGF_INFO("x={} y={}", a, b)
+// 格式串在编译期检查占位符个数, 参数按类型直接写入输出缓冲区(不经过 printf, 不分配内存)
+// {{ 和 }} 输出字面量花括号; 暂不支持 {} 内的格式说明符
+
+#define LOG_FMT_INVALID (static_cast<size_t>(-1))
+
+// 编译期统计占位符个数, 格式串非法(不成对的 { 或 }, 或 {} 内有内容)时返回 LOG_FMT_INVALID
+constexpr size_t logFmtCount(const char* s, size_t n = 0)
+{
+    return *s == '\0' ? n :
+           *s == '{' ? (s[1] == '{' ? logFmtCount(s + 2, n) : s[1] == '}' ? logFmtCount(s + 2, n + 1) : LOG_FMT_INVALID) :
+           *s == '}' ? (s[1] == '}' ? logFmtCount(s + 2, n) : LOG_FMT_INVALID) :
+           logFmtCount(s + 1, n);
+}
+
+// 编译期统计参数个数(只用于 sizeof, 不会被调用): 返回 char[N + 1] 的引用
+template <typename... Args>
+char (&logFmtArgCounter(const Args&...))[sizeof...(Args) + 1];
+
+// 00 ~ 99 的两位数字表, 整数每次转换两位
+inline const char* logFmtDigits()
+{
+    static const char digits[] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    return digits;
+}
+
+inline char* logFmtUnsigned(char* p, uint64_t v)   // 无符号整数转十进制, 返回写入后的位置
+{
+    char buffer[20];
+    char* end = buffer + sizeof(buffer);
+    char* b = end;
+    const char* digits = logFmtDigits();
+    while (v >= 100) {
+        unsigned i = static_cast<unsigned>(v % 100) * 2;
+        v /= 100;
+        b -= 2;
+        b[0] = digits[i];
+        b[1] = digits[i + 1];
+    }
+    if (v >= 10) {
+        b -= 2;
+        b[0] = digits[v * 2];
+        b[1] = digits[v * 2 + 1];
+    } else {
+        *--b = static_cast<char>('0' + v);
+    }
+    std::memcpy(p, b, end - b);
+    return p + (end - b);
+}
+
+inline char* logFmtSigned(char* p, int64_t v)
+{
+    if (v < 0) {
+        *p++ = '-';
+        return logFmtUnsigned(p, 0 - static_cast<uint64_t>(v));
+    }
+    return logFmtUnsigned(p, static_cast<uint64_t>(v));
+}
+
+inline char* logFmtHex(char* p, uint64_t v)    // 0x 前缀的十六进制(指针)
+{
+    char buffer[16];
+    char* end = buffer + sizeof(buffer);
+    char* b = end;
+    do {
+        *--b = "0123456789abcdef"[v & 0xf];
+        v >>= 4;
+    } while (v);
+    *p++ = '0';
+    *p++ = 'x';
+    std::memcpy(p, b, end - b);
+    return p + (end - b);
+}
+
+// 浮点数: 定点表示, 最多 6 位小数并去掉末尾的 0; 极大/极小值退回 %g
+inline char* logFmtDouble(char* p, double v)
+{
+    if (v != v) {
+        std::memcpy(p, "nan", 3);
+        return p + 3;
+    }
+    if (v < 0) {
+        *p++ = '-';
+        v = -v;
+    }
+    if (v > 1.7976931348623157e308) {
+        std::memcpy(p, "inf", 3);
+        return p + 3;
+    }
+    if (v >= 1e16 || (v != 0 && v < 1e-5)) {
+        return p + std::snprintf(p, 24, "%g", v);
+    }
+    uint64_t integer = static_cast<uint64_t>(v);
+    uint64_t fraction = static_cast<uint64_t>((v - integer) * 1e6 + 0.5);
+    if (fraction >= 1000000) {  // 四舍五入进位到整数部分
+        ++integer;
+        fraction -= 1000000;
+    }
+    p = logFmtUnsigned(p, integer);
+    if (fraction == 0) return p;
+    *p++ = '.';
+    char* digits = p;
+    for (int i = 5; i >= 0; --i) {
+        digits[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    p += 6;
+    while (p[-1] == '0') --p;
+    return p;
+}
+
+template <typename T>
+struct LogFmtUnsupported {
+    static const bool value = false;
+};
+
+template <typename T, typename Enable = void>
+struct LogFmtArg {  // 不支持的参数类型在编译期报错
+    static_assert(LogFmtUnsupported<T>::value, "LOGF argument must be an arithmetic, enum, pointer, C string or std::string");
+    static inline size_t bound(const T&) { return 0; }
+    static inline char* write(char* p, const T&) { return p; }
+};
+
+// 每种参数给出输出长度上界(bound)和直接写入缓冲区的实现(write)
+template <>
+struct LogFmtArg<bool> {
+    static inline size_t bound(bool) { return 5; }
+    static inline char* write(char* p, bool v) {
+        std::memcpy(p, v ? "true" : "false", v ? 4 : 5);
+        return p + (v ? 4 : 5);
+    }
+};
+
+template <>
+struct LogFmtArg<char> {
+    static inline size_t bound(char) { return 1; }
+    static inline char* write(char* p, char v) {
+        *p++ = v;
+        return p;
+    }
+};
+
+template <typename T>
+struct LogFmtArg<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                            !std::is_same<T, char>::value>::type> {
+    static inline size_t bound(T) { return 20; }
+    static inline char* write(char* p, T v) {
+        return std::is_signed<T>::value ? logFmtSigned(p, static_cast<int64_t>(v)) : logFmtUnsigned(p, static_cast<uint64_t>(v));
+    }
+};
+
+template <typename T>
+struct LogFmtArg<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static inline size_t bound(T) { return 32; }
+    static inline char* write(char* p, T v) { return logFmtDouble(p, static_cast<double>(v)); }
+};
+
+template <typename T>
+struct LogFmtArg<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+    typedef typename std::underlying_type<T>::type Underlying;
+    static inline size_t bound(T) { return 20; }
+    static inline char* write(char* p, T v) { return LogFmtArg<Underlying>::write(p, static_cast<Underlying>(v)); }
+};
+
+template <typename T>
+struct LogFmtArg<T, typename std::enable_if<std::is_same<T, const char*>::value || std::is_same<T, char*>::value>::type> {
+    static inline size_t bound(const char* v) { return v ? std::strlen(v) : 6; }
+    static inline char* write(char* p, const char* v) {
+        if (v == nullptr) v = "(null)";
+        size_t n = std::strlen(v);
+        std::memcpy(p, v, n);
+        return p + n;
+    }
+};
+
+template <typename T>
+struct LogFmtArg<T, typename std::enable_if<std::is_pointer<T>::value && !std::is_same<T, const char*>::value &&
+                                            !std::is_same<T, char*>::value>::type> {
+    static inline size_t bound(T) { return 18; }
+    static inline char* write(char* p, T v) { return logFmtHex(p, reinterpret_cast<uintptr_t>(v)); }
+};
+
+template <>
+struct LogFmtArg<std::nullptr_t> {
+    static inline size_t bound(std::nullptr_t) { return 3; }
+    static inline char* write(char* p, std::nullptr_t) { return logFmtHex(p, 0); }
+};
+
+template <>
+struct LogFmtArg<std::string> {
+    static inline size_t bound(const std::string& v) { return v.size(); }
+    static inline char* write(char* p, const std::string& v) {
+        std::memcpy(p, v.data(), v.size());
+        return p + v.size();
+    }
+};
+
+// 参数按 const 引用传入, 字符数组退化为 const char*
+template <typename T>
+using LogFmtDecay = typename std::decay<const T>::type;
+
+struct LogFmt {
+    // 输出长度上界: 格式串长度 + 各参数上界, 调用方按此预留缓冲区后一次写完
+    static inline size_t bound(const char* fmt) { return std::strlen(fmt); }
+    template <typename T, typename... Rest>
+    static inline size_t bound(const char* fmt, const T& v, const Rest&... rest) {
+        return LogFmtArg<LogFmtDecay<T>>::bound(v) + bound(fmt, rest...);
+    }
+
+    static inline char* write(char* p, const char* fmt) {
+        return literal(p, fmt);
+    }
+    template <typename T, typename... Rest>
+    static inline char* write(char* p, const char* fmt, const T& v, const Rest&... rest) {
+        p = literal(p, fmt);
+        if (*fmt == '\0') return p;     // 占位符少于参数(只会出现在直接调用时), 多余参数忽略
+        p = LogFmtArg<LogFmtDecay<T>>::write(p, v);
+        return write(p, fmt + 2, rest...);
+    }
+
+private:
+    // 拷贝字面量直到下一个 {} 或结尾, fmt 指向停下的位置
+    static inline char* literal(char* p, const char*& fmt) {
+        for (;;) {
+            char c = *fmt;
+            if (c == '\0') return p;
+            if (c == '{' && fmt[1] == '}') return p;
+            if ((c == '{' && fmt[1] == '{') || (c == '}' && fmt[1] == '}')) ++fmt;
+            *p++ = c;
+            ++fmt;
+        }
+    }
+};
+
+// 编译期检查格式串与参数个数(sizeof 不求值, 参数不会被计算)
+#define LOGF_CHECK(fmt, ...) \
+    static_assert(logFmtCount(fmt) != LOG_FMT_INVALID, "LOGF: unbalanced '{' or '}' in format string"); \
+    static_assert(logFmtCount(fmt) == sizeof(logFmtArgCounter(__VA_ARGS__)) - 1, "LOGF: placeholder count does not match argument count")
+
+#endif // LOGGER_FMT_H
@@ -0,0 +1,112 @@
+#ifndef LOGGER_INDEX_H
+#define LOGGER_INDEX_H
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 日志索引文件(<日志文件>.idx): 日志线程每写满约 interval 字节结束一个块, 记录块的位置、时间范围和出现过的级别
+// 查询时按时间二分查找相关的块, 只读取这些块(logcat); 未被索引覆盖的部分(异常退出、当前未写完的块)按顺序扫描
+// 二进制格式的每个块以文件头记录开始, 可以单独解码; 流式压缩的日志文件每个压缩帧一个索引项, 偏移为压缩文件中的位置
+// 文件格式: "LOGI" 版本(uint32) 之后为定长索引项(主机字节序); 同一日志文件重新打开时继续追加
+#define LOG_INDEX_MAGIC "LOGI"
+#define LOG_INDEX_VERSION 1
+
+// 索引项: 日志文件中一段连续记录
+struct LogIndexEntry {
+    uint64_t offset;    // 块在日志文件中的起始偏移
+    uint64_t length;    // 块长度(字节)
+    int64_t minNanos;   // 块内最早的日志时间(纪元纳秒)
+    int64_t maxNanos;   // 块内最晚的日志时间
+    uint32_t count;     // 记录条数
+    uint32_t levels;    // 出现过的级别, 第 i 位对应级别 i
+};
+
+// 索引写入器(仅日志线程使用)
+class LogIndexWriter {
+public:
+    LogIndexWriter(const LogIndexWriter&) = delete;
+    LogIndexWriter& operator=(const LogIndexWriter&) = delete;
+    LogIndexWriter() {}
+    ~LogIndexWriter() {
+        if (file != nullptr) std::fclose(file);
+    }
+
+    inline bool open(const std::string& path, uint64_t blockSize) {
+        close(0);
+        file = std::fopen(path.c_str(), "ab");
+        if (file == nullptr) return false;
+        if (std::ftell(file) == 0) {
+            uint32_t version = LOG_INDEX_VERSION;
+            std::fwrite(LOG_INDEX_MAGIC, 1, 4, file);
+            std::fwrite(&version, sizeof(version), 1, file);
+            std::fflush(file);
+        }
+        interval = blockSize;
+        return true;
+    }
+    inline void close(uint64_t endOffset) {    // 写出未完成的块(endOffset 为日志文件当前长度)
+        if (file == nullptr) return;
+        if (inBlock) finishBlock(endOffset);
+        std::fclose(file);
+        file = nullptr;
+    }
+    inline bool isOpen() const { return file != nullptr; }
+
+    // 下一条记录是否需要开始新块(还没有块, 或当前块已超过 interval)
+    inline bool blockFull(uint64_t offset) const {
+        return !inBlock || offset - current.offset >= interval;
+    }
+    inline void startBlock(uint64_t offset) {
+        if (inBlock) finishBlock(offset);
+        current.offset = offset;
+        current.length = 0;
+        current.minNanos = INT64_MAX;
+        current.maxNanos = INT64_MIN;
+        current.count = 0;
+        current.levels = 0;
+        inBlock = true;
+    }
+    inline void endBlock(uint64_t endOffset) {  // 结束当前块(压缩帧写出后调用)
+        if (inBlock) finishBlock(endOffset);
+    }
+    inline void add(int64_t nanos, int level) {
+        if (nanos < current.minNanos) current.minNanos = nanos;
+        if (nanos > current.maxNanos) current.maxNanos = nanos;
+        ++current.count;
+        current.levels |= 1u << level;
+    }
+
+private:
+    inline void finishBlock(uint64_t endOffset) {
+        inBlock = false;
+        if (current.count == 0) return;     // 空块不写, 查询时按未索引部分扫描
+        current.length = endOffset - current.offset;
+        std::fwrite(&current, sizeof(current), 1, file);
+        std::fflush(file);  // 每块一次, 正在写的日志文件也能按索引查询
+    }
+
+    std::FILE* file = nullptr;  // 索引文件
+    uint64_t interval = 0;      // 块大小
+    LogIndexEntry current;      // 当前块
+    bool inBlock = false;       // 是否有未完成的块
+};
+
+// 读取索引文件, 文件不存在或格式不符时返回 false
+inline bool logReadIndex(const std::string& path, std::vector<LogIndexEntry>& entries)
+{
+    entries.clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    char magic[4];
+    uint32_t version = 0;
+    bool ok = std::fread(magic, 1, 4, file) == 4 && std::memcmp(magic, LOG_INDEX_MAGIC, 4) == 0 &&
+              std::fread(&version, sizeof(version), 1, file) == 1 && version == LOG_INDEX_VERSION;
+    LogIndexEntry entry;
+    while (ok && std::fread(&entry, sizeof(entry), 1, file) == 1) entries.push_back(entry);
+    std::fclose(file);
+    return ok;
+}
+
+#endif // LOGGER_INDEX_H
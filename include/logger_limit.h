@@ -0,0 +1,99 @@
+#ifndef LOGGER_LIMIT_H
+#define LOGGER_LIMIT_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// 调用点限流状态: 每个 LOG_EVERY_N/LOG_FIRST_N/LOG_EVERY_MS/LOG_RATE_LIMITED 调用点一个静态对象(常量初始化, 无构造锁)
+// 只使用 relaxed 原子操作; allow 返回本次是否输出, 输出时 suppressed 为自上次输出以来被抑制的次数
+// 被抑制的调用不格式化、不取日志时间戳、不入队
+
+static inline int64_t logSteadyNanos()  // 限流使用单调时钟, 不受系统时间调整影响
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 每 n 次输出一次(第 1、n+1、2n+1 ... 次)
+class LogEveryN {
+public:
+    inline bool allow(uint64_t n, uint64_t& suppressed) {
+        uint64_t count = calls.fetch_add(1, std::memory_order_relaxed);
+        if (n <= 1) return true;
+        if (count % n != 0) return false;
+        suppressed = count == 0 ? 0 : n - 1;
+        return true;
+    }
+
+private:
+    std::atomic<uint64_t> calls{0};     // 调用次数
+};
+
+// 只输出前 n 次
+class LogFirstN {
+public:
+    inline bool allow(uint64_t n, uint64_t& suppressed) {
+        (void)suppressed;
+        if (calls.load(std::memory_order_relaxed) >= n) return false;  // 达到上限后只读, 不再写共享缓存行
+        return calls.fetch_add(1, std::memory_order_relaxed) < n;
+    }
+
+private:
+    std::atomic<uint64_t> calls{0};     // 已放行次数(可能略超过 n, 不影响判断)
+};
+
+// 每 ms 毫秒最多输出一次
+class LogEveryMs {
+public:
+    inline bool allow(int64_t ms, uint64_t& suppressed) {
+        int64_t now = logSteadyNanos();
+        int64_t next = nextNanos.load(std::memory_order_relaxed);
+        if (now < next || !nextNanos.compare_exchange_strong(next, now + ms * 1000000LL, std::memory_order_relaxed)) {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = skipped.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::atomic<int64_t> nextNanos{0};  // 下一次允许输出的时间
+    std::atomic<uint64_t> skipped{0};   // 自上次输出以来被抑制的次数
+};
+
+// 令牌桶: 平均每秒 rate 条, 最多连续突发 burst 条
+// 按 GCRA 实现, 只用一个原子量记录"理论到达时间", 等价于容量 burst、每 1/rate 秒补充一个令牌的令牌桶
+class LogRateLimiter {
+public:
+    inline bool allow(double rate, uint64_t burst, uint64_t& suppressed) {
+        int64_t interval = rate > 0 ? static_cast<int64_t>(1e9 / rate) : INT64_MAX / 4;
+        int64_t tolerance = burst > 1 ? static_cast<int64_t>(burst - 1) * interval : 0;
+        int64_t now = logSteadyNanos();
+        int64_t tat = arrival.load(std::memory_order_relaxed);
+        for (;;) {
+            int64_t base = tat > now ? tat : now;
+            if (base - now > tolerance) {   // 令牌已用完
+                skipped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (arrival.compare_exchange_weak(tat, base + interval, std::memory_order_relaxed)) break;
+        }
+        suppressed = skipped.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::atomic<int64_t> arrival{0};    // 理论到达时间
+    std::atomic<uint64_t> skipped{0};   // 自上次输出以来被抑制的次数
+};
+
+// 输出时写在日志内容前的抑制计数, 没有抑制时为空串
+static inline const char* logSuppressedNote(char* buffer, size_t size, uint64_t suppressed)
+{
+    if (suppressed == 0) return "";
+    std::snprintf(buffer, size, "(suppressed %llu) ", static_cast<unsigned long long>(suppressed));
+    return buffer;
+}
+
+#endif // LOGGER_LIMIT_H
@@ -0,0 +1,75 @@
+#ifndef LOGGER_POOL_H
+#define LOGGER_POOL_H
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "logger_ring.h"
+
+// 溢出块规格数: 1K、4K、16K、64K, 更大的日志按实际大小分配且不回收
+#ifndef LOG_SPILL_CLASSES
+#define LOG_SPILL_CLASSES 4
+#endif
+#ifndef LOG_SPILL_MIN_SIZE
+#define LOG_SPILL_MIN_SIZE 1024
+#endif
+
+// 溢出块: 放不进队列槽位内联缓冲区的日志内容, 数据区紧跟在块头之后
+struct LogSpillBlock {
+    size_t capacity;    // 数据区容量
+    int sizeClass;      // 所属规格, LOG_SPILL_CLASSES 表示不回收
+
+    inline char* data() { return reinterpret_cast<char*>(this + 1); }
+    inline const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+};
+
+// 溢出块池: 每种规格一个无锁空闲队列, 调用方线程取块, 日志线程处理完后归还
+// 预热后长日志也不再分配内存; 空闲队列满时多余的块直接释放
+class LogSpillPool {
+public:
+    LogSpillPool(const LogSpillPool&) = delete;
+    LogSpillPool& operator=(const LogSpillPool&) = delete;
+    LogSpillPool() {
+        size_t keep = 256;  // 各规格最多保留的空闲块数, 规格越大保留越少
+        for (int i = 0; i < LOG_SPILL_CLASSES; ++i) {
+            freeLists[i] = new LogRingBuffer<LogSpillBlock*>(keep);
+            keep = keep > 8 ? keep / 2 : keep;
+        }
+    }
+    ~LogSpillPool() {
+        for (int i = 0; i < LOG_SPILL_CLASSES; ++i) {
+            LogSpillBlock* block;
+            while (freeLists[i]->tryPop(block)) ::operator delete(block);
+            delete freeLists[i];
+        }
+    }
+
+    inline LogSpillBlock* acquire(size_t size) {
+        int cls = classOf(size);
+        LogSpillBlock* block;
+        if (cls < LOG_SPILL_CLASSES && freeLists[cls]->tryPop(block)) return block;
+        size_t capacity = cls < LOG_SPILL_CLASSES ? classSize(cls) : size;
+        block = static_cast<LogSpillBlock*>(::operator new(sizeof(LogSpillBlock) + capacity));
+        block->capacity = capacity;
+        block->sizeClass = cls;
+        return block;
+    }
+    inline void release(LogSpillBlock* block) {
+        if (block->sizeClass < LOG_SPILL_CLASSES && freeLists[block->sizeClass]->tryPush(std::move(block))) return;
+        ::operator delete(block);
+    }
+
+private:
+    static inline size_t classSize(int cls) {
+        return static_cast<size_t>(LOG_SPILL_MIN_SIZE) << (2 * cls);
+    }
+    static inline int classOf(size_t size) {
+        int cls = 0;
+        while (cls < LOG_SPILL_CLASSES && size > classSize(cls)) ++cls;
+        return cls;
+    }
+
+    LogRingBuffer<LogSpillBlock*>* freeLists[LOG_SPILL_CLASSES];   // 各规格的空闲块
+};
+
+#endif // LOGGER_POOL_H
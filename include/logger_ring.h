@@ -0,0 +1,226 @@
+#ifndef LOGGER_RING_H
+#define LOGGER_RING_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+// 缓存行大小, 用于隔离生产者/消费者游标, 避免伪共享
+#ifndef LOG_CACHELINE_SIZE
+#define LOG_CACHELINE_SIZE 64
+#endif
+
+// 有界无锁环形队列(基于 Vyukov 序号槽算法)
+// 槽位在构造时一次性分配, 每个槽位独占缓存行; 多生产者通过 CAS 抢占写游标,
+// 消费者同样通过 CAS 推进读游标, 因此既可作为 MPSC 使用, 也允许生产者在溢出时丢弃最旧消息。
+// 容量会向上取整为 2 的幂。
+template <typename T>
+class LogRingBuffer {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;   // 槽位序号, 标记槽位当前可写/可读
+        T data;                         // 槽位数据
+    };
+    // 槽位按缓存行对齐并填充到整数倍
+    static const size_t CELL_STRIDE = (sizeof(Cell) + LOG_CACHELINE_SIZE - 1) / LOG_CACHELINE_SIZE * LOG_CACHELINE_SIZE;
+
+public:
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+    explicit LogRingBuffer(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask = cap - 1;
+        // 多分配一个缓存行用于手工对齐(C++11 的 new 不保证超对齐)
+        rawBuffer = static_cast<char*>(std::malloc(CELL_STRIDE * cap + LOG_CACHELINE_SIZE));
+        if (rawBuffer == nullptr) throw std::bad_alloc();
+        uintptr_t addr = reinterpret_cast<uintptr_t>(rawBuffer);
+        cells = reinterpret_cast<char*>((addr + LOG_CACHELINE_SIZE - 1) & ~static_cast<uintptr_t>(LOG_CACHELINE_SIZE - 1));
+        for (size_t i = 0; i < cap; ++i) {
+            Cell* cell = new (cells + i * CELL_STRIDE) Cell();
+            cell->sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+    ~LogRingBuffer() {
+        for (size_t i = 0; i <= mask; ++i) {
+            cellAt(i)->~Cell();
+        }
+        std::free(rawBuffer);
+    }
+
+    // 生产者: 抢占一个空槽位, 成功返回槽位数据指针, 填充后必须调用 publish(pos)
+    inline T* tryAcquire(size_t& pos) {
+        size_t cur = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell = cellAt(cur);
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(cur);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(cur, cur + 1, std::memory_order_relaxed)) {
+                    pos = cur;
+                    return &cell->data;
+                }
+            } else if (diff < 0) {
+                return nullptr;     // 队列已满
+            } else {
+                cur = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    inline void publish(size_t pos) {
+        cellAt(pos)->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    // 消费者: 取得最旧的已发布槽位, 处理完毕后必须调用 release(pos)
+    inline T* tryConsume(size_t& pos) {
+        size_t cur = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell = cellAt(cur);
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(cur + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(cur, cur + 1, std::memory_order_relaxed)) {
+                    pos = cur;
+                    return &cell->data;
+                }
+            } else if (diff < 0) {
+                return nullptr;     // 队列为空(或最旧槽位尚未发布)
+            } else {
+                cur = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    inline void release(size_t pos) {
+        cellAt(pos)->sequence.store(pos + mask + 1, std::memory_order_release);
+    }
+
+    inline bool tryPush(T&& item) {
+        size_t pos;
+        T* slot = tryAcquire(pos);
+        if (slot == nullptr) return false;
+        *slot = std::move(item);
+        publish(pos);
+        return true;
+    }
+    inline void push(T&& item) {  // 队列满时自旋让出CPU直到有空位
+        size_t pos;
+        T* slot;
+        while ((slot = tryAcquire(pos)) == nullptr) {
+            std::this_thread::yield();
+        }
+        *slot = std::move(item);
+        publish(pos);
+    }
+    inline bool tryPop(T& item) {
+        size_t pos;
+        T* slot = tryConsume(pos);
+        if (slot == nullptr) return false;
+        item = std::move(*slot);
+        release(pos);
+        return true;
+    }
+
+    inline size_t capacity() const { return mask + 1; }
+    inline size_t size() const {  // 近似值, 仅用于统计
+        size_t head = dequeuePos.load(std::memory_order_relaxed);
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+    inline bool empty() const { return size() == 0; }
+    inline size_t enqueuePosition() const { return enqueuePos.load(std::memory_order_acquire); }   // 已分配的槽位总数
+    inline size_t dequeuePosition() const { return dequeuePos.load(std::memory_order_acquire); }   // 已取出的槽位总数
+    // 查看 pos 处已发布但尚未取出的槽位(不移动游标, 供崩溃转储使用), 未发布时返回 nullptr
+    inline const T* peek(size_t pos) const {
+        const Cell* cell = cellAt(pos);
+        return cell->sequence.load(std::memory_order_acquire) == pos + 1 ? &cell->data : nullptr;
+    }
+
+private:
+    inline Cell* cellAt(size_t pos) const {
+        return reinterpret_cast<Cell*>(cells + (pos & mask) * CELL_STRIDE);
+    }
+
+    char pad0[LOG_CACHELINE_SIZE];
+    std::atomic<size_t> enqueuePos;     // 生产者写游标
+    char pad1[LOG_CACHELINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeuePos;     // 消费者读游标
+    char pad2[LOG_CACHELINE_SIZE - sizeof(std::atomic<size_t>)];
+    size_t mask;                        // 容量掩码
+    char* cells;                        // 对齐后的槽位起始地址
+    char* rawBuffer;                    // 原始内存
+};
+
+// 有界单生产者单消费者环形队列(每个生产者线程一个)
+// 生产者和消费者各自缓存对方的游标, 只有在缓存值显示队列满/空时才读取对方的缓存行,
+// 热路径上各线程只写自己的缓存行, 不会在多个生产者之间来回传递。容量会向上取整为 2 的幂。
+template <typename T>
+class LogSpscRing {
+public:
+    LogSpscRing(const LogSpscRing&) = delete;
+    LogSpscRing& operator=(const LogSpscRing&) = delete;
+    explicit LogSpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask = cap - 1;
+        slots = new T[cap];
+        tailPos.store(0, std::memory_order_relaxed);
+        headPos.store(0, std::memory_order_relaxed);
+    }
+    ~LogSpscRing() {
+        delete[] slots;
+    }
+
+    // 生产者: 取得下一个空槽位, 填充后必须调用 publish(); 队列满返回 nullptr
+    inline T* tryAcquire() {
+        size_t tail = tailPos.load(std::memory_order_relaxed);
+        if (tail - cachedHead > mask) {
+            cachedHead = headPos.load(std::memory_order_acquire);
+            if (tail - cachedHead > mask) return nullptr;
+        }
+        return &slots[tail & mask];
+    }
+    inline void publish() {
+        tailPos.store(tailPos.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 消费者: 查看最旧的已发布槽位, 处理完毕后调用 pop(); 队列空返回 nullptr
+    inline T* front() {
+        size_t head = headPos.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tailPos.load(std::memory_order_acquire);
+            if (head == cachedTail) return nullptr;
+        }
+        return &slots[head & mask];
+    }
+    inline void pop() {
+        headPos.store(headPos.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    inline size_t capacity() const { return mask + 1; }
+    inline size_t size() const {  // 近似值, 仅用于统计
+        size_t head = headPos.load(std::memory_order_relaxed);
+        size_t tail = tailPos.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+    inline bool empty() const { return size() == 0; }
+    inline size_t headPosition() const { return headPos.load(std::memory_order_acquire); }
+    inline size_t tailPosition() const { return tailPos.load(std::memory_order_acquire); }
+    inline const T* at(size_t pos) const { return &slots[pos & mask]; }     // 崩溃转储使用
+
+private:
+    char pad0[LOG_CACHELINE_SIZE];
+    std::atomic<size_t> tailPos;        // 生产者写游标
+    size_t cachedHead = 0;              // 生产者缓存的读游标
+    char pad1[LOG_CACHELINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    std::atomic<size_t> headPos;        // 消费者读游标
+    size_t cachedTail = 0;              // 消费者缓存的写游标
+    char pad2[LOG_CACHELINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    size_t mask;                        // 容量掩码
+    T* slots;                           // 槽位数组
+};
+
+#endif // LOGGER_RING_H
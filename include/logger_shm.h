@@ -0,0 +1,404 @@
+#ifndef LOGGER_SHM_H
+#define LOGGER_SHM_H
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 共享内存传输: 每个进程一个命名 POSIX 共享内存段(/logger.<模块>.<pid>), 其中是一个无锁多生产者环形队列,
+// 由独立的采集进程 logd 取出、按时间戳归并后批量写入日志文件, 多个进程不再各自写文件
+// 日志写入共享内存并发布后即已提交: 进程崩溃(包括 SIGKILL)不影响已提交的日志, logd 取空后删除共享内存段
+// 仅 POSIX 平台支持; Windows 下 open 返回 false, 由调用方继续写本地文件
+
+// 日志输出方式
+enum LogTransport {
+    LOG_TRANSPORT_FILE,     // 日志线程写本进程的日志文件(默认)
+    LOG_TRANSPORT_SHM,      // 写入共享内存环形队列, 由 logd 统一写文件
+};
+
+// 共享内存段名称前缀(logd 按该前缀扫描 LOG_SHM_DIR)
+#ifndef LOG_SHM_PREFIX
+#define LOG_SHM_PREFIX "logger."
+#endif
+// 共享内存段所在目录(Linux 下 shm_open 的名字对应 /dev/shm 中的文件)
+#ifndef LOG_SHM_DIR
+#define LOG_SHM_DIR "/dev/shm"
+#endif
+// 默认共享内存队列大小(字节, 不含 256 字节的段头部)
+#ifndef LOG_SHM_SIZE
+#define LOG_SHM_SIZE (4u << 20)
+#endif
+// 单元大小: 一条日志占用 1 个或多个连续单元
+#ifndef LOG_SHM_CELL_SIZE
+#define LOG_SHM_CELL_SIZE 128
+#endif
+// logd 心跳超时(毫秒): 超时后认为没有采集进程, 队列满时不再等待
+#ifndef LOG_SHM_COLLECTOR_TIMEOUT_MS
+#define LOG_SHM_COLLECTOR_TIMEOUT_MS 3000
+#endif
+
+#define LOG_SHM_MAGIC 0x4c4f4753u   // "LOGS"
+#define LOG_SHM_VERSION 1u
+#define LOG_SHM_HEADER_SIZE 256
+
+// 共享内存段头部: 所有字段在 magic 之前初始化, logd 看到 magic 后才读取
+struct LogShmHeader {
+    std::atomic<uint32_t> magic;        // 初始化完成标记
+    uint32_t version;                   // 格式版本
+    uint64_t capacity;                  // 单元数(2 的幂)
+    int64_t pid;                        // 生产者进程号
+    int64_t createNanos;                // 创建时间
+    char module[64];                    // 生产者模块名
+    std::atomic<int64_t> heartbeat;     // logd 最近一次访问的时间(纪元纳秒)
+    std::atomic<uint32_t> closed;       // 生产者已正常停止
+    alignas(64) std::atomic<uint64_t> enqueuePos;   // 写位置(生产者之间 CAS)
+    alignas(64) std::atomic<uint64_t> dequeuePos;   // 读位置(logd 独占, 保存在共享内存中, logd 重启后继续)
+};
+
+// 单元: seq 为 pos 表示空闲可写, pos + 1 表示已发布; span 为记录首单元的单元数, 后续单元为 0
+struct LogShmCell {
+    std::atomic<uint64_t> seq;
+    uint32_t span;
+    uint32_t reserved;
+    char data[LOG_SHM_CELL_SIZE - 16];
+};
+
+// 记录头(位于首单元 data 开头), 之后是日志内容, 依次写入后续单元
+struct LogShmRecordHead {
+    int64_t nanos;      // 日志时间(纪元纳秒)
+    uint32_t length;    // 内容长度
+    uint8_t level;      // 日志级别
+    uint8_t padding[3];
+};
+
+static_assert(sizeof(LogShmHeader) <= LOG_SHM_HEADER_SIZE, "LogShmHeader too large");
+static_assert(sizeof(LogShmCell) == LOG_SHM_CELL_SIZE, "LogShmCell size mismatch");
+
+// 读出的一条日志
+struct LogShmRecord {
+    int64_t nanos = 0;
+    int level = 0;
+    std::string text;
+};
+
+// 共享内存中的环形队列布局(生产者和 logd 共用)
+class LogShmRing {
+public:
+    static const size_t HEAD_DATA = sizeof(LogShmCell::data) - sizeof(LogShmRecordHead);   // 首单元可放的内容字节数
+    static const size_t CELL_DATA = sizeof(LogShmCell::data);                             // 后续单元可放的内容字节数
+
+    static inline uint64_t cellsFor(size_t length) {   // 一条日志占用的单元数
+        return length <= HEAD_DATA ? 1 : 1 + (length - HEAD_DATA + CELL_DATA - 1) / CELL_DATA;
+    }
+    static inline uint64_t cellCount(size_t bytes) {   // 队列字节数对应的单元数(向上取 2 的幂, 至少 16)
+        uint64_t capacity = 16;
+        while (capacity * LOG_SHM_CELL_SIZE < bytes) capacity *= 2;
+        return capacity;
+    }
+    static inline size_t segmentSize(uint64_t capacity) {
+        return LOG_SHM_HEADER_SIZE + static_cast<size_t>(capacity) * LOG_SHM_CELL_SIZE;
+    }
+
+protected:
+    inline LogShmCell& cell(uint64_t pos) const { return cells[pos & (header->capacity - 1)]; }
+    // 把 [offset, offset + length) 的记录字节拷贝进/出从 pos 开始的单元(记录头占首单元开头)
+    inline void copyIn(uint64_t pos, size_t offset, const char* data, size_t length) const {
+        while (length > 0) {
+            uint64_t index = offset < CELL_DATA ? 0 : 1 + (offset - CELL_DATA) / CELL_DATA;
+            size_t within = index == 0 ? offset : (offset - CELL_DATA) % CELL_DATA;
+            size_t n = std::min(length, CELL_DATA - within);
+            std::memcpy(cell(pos + index).data + within, data, n);
+            data += n;
+            offset += n;
+            length -= n;
+        }
+    }
+    inline void copyOut(uint64_t pos, size_t offset, char* data, size_t length) const {
+        while (length > 0) {
+            uint64_t index = offset < CELL_DATA ? 0 : 1 + (offset - CELL_DATA) / CELL_DATA;
+            size_t within = index == 0 ? offset : (offset - CELL_DATA) % CELL_DATA;
+            size_t n = std::min(length, CELL_DATA - within);
+            std::memcpy(data, cell(pos + index).data + within, n);
+            data += n;
+            offset += n;
+            length -= n;
+        }
+    }
+
+    LogShmHeader* header = nullptr;     // 段头部
+    LogShmCell* cells = nullptr;        // 单元数组
+    size_t mappedSize = 0;              // 映射长度
+};
+
+// 生产者: 多个线程无锁写入(日志调用线程、日志线程和崩溃处理函数)
+// 先用 CAS 一次预留一条记录的全部单元, 写入内容后从后往前发布, 首单元最后发布, logd 看到首单元即可读取整条记录
+// push 不分配内存、不加锁, 可在信号处理函数中调用
+class LogShmWriter : public LogShmRing {
+public:
+    LogShmWriter(const LogShmWriter&) = delete;
+    LogShmWriter& operator=(const LogShmWriter&) = delete;
+    LogShmWriter() {}
+
+    // 创建 /logger.<模块>.<pid> 并初始化; 同名段已存在(上一个同 pid 进程的残留)时依次尝试 .1 ~ .15 后缀, 不覆盖未采集的日志
+    inline bool open(const std::string& moduleName, size_t bytes) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (isOpen()) return true;
+        std::string base = std::string("/") + LOG_SHM_PREFIX;
+        for (size_t i = 0; i < moduleName.size(); ++i) base += moduleName[i] == '/' ? '_' : moduleName[i];
+        base += "." + std::to_string(static_cast<long long>(getpid()));
+        uint64_t capacity = cellCount(bytes);
+        size_t size = segmentSize(capacity);
+        for (int attempt = 0; attempt < 16; ++attempt) {
+            std::string candidate = attempt == 0 ? base : base + "." + std::to_string(attempt);
+            int fd = shm_open(candidate.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+            if (fd < 0) {
+                if (errno == EEXIST) continue;
+                return false;
+            }
+            void* memory = ftruncate(fd, static_cast<off_t>(size)) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if (memory == MAP_FAILED) {
+                shm_unlink(candidate.c_str());
+                return false;
+            }
+            LogShmHeader* h = new (memory) LogShmHeader();
+            h->version = LOG_SHM_VERSION;
+            h->capacity = capacity;
+            h->pid = getpid();
+            h->createNanos = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            std::strncpy(h->module, moduleName.c_str(), sizeof(h->module) - 1);
+            h->heartbeat.store(0, std::memory_order_relaxed);
+            h->closed.store(0, std::memory_order_relaxed);
+            h->enqueuePos.store(0, std::memory_order_relaxed);
+            h->dequeuePos.store(0, std::memory_order_relaxed);
+            LogShmCell* c = reinterpret_cast<LogShmCell*>(static_cast<char*>(memory) + LOG_SHM_HEADER_SIZE);
+            for (uint64_t pos = 0; pos < capacity; ++pos) {
+                new (&c[pos]) LogShmCell();
+                c[pos].seq.store(pos, std::memory_order_relaxed);
+            }
+            cells = c;
+            mappedSize = size;
+            shmName = candidate;
+            h->magic.store(LOG_SHM_MAGIC, std::memory_order_release);
+            header = h;
+            ready.store(true, std::memory_order_release);
+            return true;
+        }
+        return false;
+#else
+        (void)moduleName;
+        (void)bytes;
+        return false;
+#endif
+    }
+    inline bool isOpen() const { return ready.load(std::memory_order_acquire); }
+    inline const std::string& name() const { return shmName; }
+
+    // 停止写入: 标记 closed, 队列已空时直接删除共享内存段, 否则留给 logd 取空后删除
+    // 不解除映射: 其他线程可能仍在 push 途中
+    inline void close() {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (!ready.exchange(false)) return;
+        header->closed.store(1, std::memory_order_release);
+        if (header->dequeuePos.load(std::memory_order_acquire) == header->enqueuePos.load(std::memory_order_acquire)) {
+            shm_unlink(shmName.c_str());
+        }
+#endif
+    }
+
+    // 是否有 logd 在采集(心跳未超时); logd 尚未访问过时从创建时间算起, 给 logd 扫描到新段留出时间
+    inline bool collectorAlive(int64_t nowNanos) const {
+        int64_t beat = header->heartbeat.load(std::memory_order_relaxed);
+        if (beat == 0) beat = header->createNanos;
+        return nowNanos - beat < static_cast<int64_t>(LOG_SHM_COLLECTOR_TIMEOUT_MS) * 1000000LL;
+    }
+
+    // 写入一条由若干段内容组成的日志, 队列满时返回 false; 超出队列一半容量的内容被截断
+    inline bool push(int level, int64_t nanos, const char* const* parts, const size_t* lengths, int count) {
+        size_t length = 0;
+        for (int i = 0; i < count; ++i) length += lengths[i];
+        size_t limit = static_cast<size_t>(header->capacity / 2) * CELL_DATA;
+        if (length > limit) length = limit;
+        uint64_t span = cellsFor(length);
+        uint64_t pos = header->enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t seq = cell(pos).seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                // logd 按顺序释放单元, 最后一个单元空闲时前面的单元也已空闲
+                if (cell(pos + span - 1).seq.load(std::memory_order_acquire) != pos + span - 1) return false;
+                if (header->enqueuePos.compare_exchange_weak(pos, pos + span, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   // 队列满
+            } else {
+                pos = header->enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        LogShmRecordHead head;
+        std::memset(&head, 0, sizeof(head));
+        head.nanos = nanos;
+        head.length = static_cast<uint32_t>(length);
+        head.level = static_cast<uint8_t>(level);
+        std::memcpy(cell(pos).data, &head, sizeof(head));
+        size_t offset = sizeof(head);
+        size_t remaining = length;
+        for (int i = 0; i < count && remaining > 0; ++i) {
+            size_t n = std::min(lengths[i], remaining);
+            copyIn(pos, offset, parts[i], n);
+            offset += n;
+            remaining -= n;
+        }
+        for (uint64_t i = span; i-- > 0;) {     // 从后往前发布, 首单元最后发布
+            LogShmCell& c = cell(pos + i);
+            c.span = i == 0 ? static_cast<uint32_t>(span) : 0;
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+    inline bool push(int level, int64_t nanos, const char* text, size_t length) {
+        return push(level, nanos, &text, &length, 1);
+    }
+
+private:
+    std::atomic<bool> ready{false};     // 是否可写
+    std::string shmName;                // 共享内存段名称
+};
+
+// logd 读取端: 每个共享内存段一个, 只在 logd 的采集线程中使用
+// 生产者进程已退出时, 跳过它预留后未发布的单元(写到一半时崩溃), 不会因此阻塞后面已提交的日志
+class LogShmReader : public LogShmRing {
+public:
+    LogShmReader(const LogShmReader&) = delete;
+    LogShmReader& operator=(const LogShmReader&) = delete;
+    LogShmReader() {}
+    ~LogShmReader() {
+        detach(false);
+    }
+
+    // 映射已存在的共享内存段(name 为 shm_open 名称, 以 / 开头); 段尚未初始化完成或格式不符时返回 false
+    inline bool attach(const std::string& name) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        void* base = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(LOG_SHM_HEADER_SIZE)) {
+            base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (base == MAP_FAILED) return false;
+        LogShmHeader* h = static_cast<LogShmHeader*>(base);
+        if (h->magic.load(std::memory_order_acquire) != LOG_SHM_MAGIC || h->version != LOG_SHM_VERSION ||
+            h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0 ||
+            segmentSize(h->capacity) > static_cast<size_t>(st.st_size)) {
+            munmap(base, static_cast<size_t>(st.st_size));
+            return false;
+        }
+        header = h;
+        cells = reinterpret_cast<LogShmCell*>(static_cast<char*>(base) + LOG_SHM_HEADER_SIZE);
+        mappedSize = static_cast<size_t>(st.st_size);
+        shmName = name;
+        return true;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+    // 解除映射, unlink 为 true 时同时删除共享内存段
+    inline void detach(bool unlink) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (header == nullptr) return;
+        munmap(header, mappedSize);
+        if (unlink) shm_unlink(shmName.c_str());
+#endif
+        header = nullptr;
+        cells = nullptr;
+    }
+    inline const std::string& name() const { return shmName; }
+    inline const char* module() const { return header->module; }
+    inline int64_t pid() const { return header->pid; }
+    inline uint64_t skipped() const { return skippedCells; }    // 因生产者崩溃跳过的未发布单元数
+    inline void heartbeat(int64_t nowNanos) { header->heartbeat.store(nowNanos, std::memory_order_relaxed); }
+
+    // 生产者是否已结束(正常停止或进程已退出); 之后不会再有新的日志
+    inline bool finished() const {
+        return header->closed.load(std::memory_order_acquire) != 0 || !producerAlive();
+    }
+    inline bool drained() const {
+        return header->dequeuePos.load(std::memory_order_relaxed) == header->enqueuePos.load(std::memory_order_acquire);
+    }
+
+    // 读取队头的一条日志(不移出), 没有已发布的日志时返回 false
+    inline bool peek(LogShmRecord& record) {
+        for (;;) {
+            uint64_t pos = header->dequeuePos.load(std::memory_order_relaxed);
+            LogShmCell& first = cell(pos);
+            if (first.seq.load(std::memory_order_acquire) == pos + 1) {
+                uint64_t span = first.span;
+                if (span == 0 || span > header->capacity / 2 + 1 || !published(pos, span)) {
+                    release(pos, 1);    // 崩溃时留下的孤立后续单元
+                    ++skippedCells;
+                    continue;
+                }
+                LogShmRecordHead head;
+                std::memcpy(&head, first.data, sizeof(head));
+                size_t length = std::min<size_t>(head.length, (span - 1) * CELL_DATA + HEAD_DATA);
+                record.nanos = head.nanos;
+                record.level = head.level;
+                record.text.resize(length);
+                if (length > 0) copyOut(pos, sizeof(head), &record.text[0], length);
+                pendingSpan = span;
+                return true;
+            }
+            if (pos == header->enqueuePos.load(std::memory_order_acquire)) return false;   // 队列空
+            if (producerAlive()) return false;  // 生产者正在写入该记录
+            release(pos, 1);    // 生产者预留后未发布就退出了: 跳过该单元
+            ++skippedCells;
+        }
+    }
+    // 移出 peek 返回的日志, 释放它占用的单元
+    inline void pop() {
+        release(header->dequeuePos.load(std::memory_order_relaxed), pendingSpan);
+        pendingSpan = 0;
+    }
+
+private:
+    inline bool producerAlive() const {
+#if !defined(_WIN32) && !defined(_WIN64)
+        return kill(static_cast<pid_t>(header->pid), 0) == 0 || errno == EPERM;
+#else
+        return true;
+#endif
+    }
+    inline bool published(uint64_t pos, uint64_t span) const {
+        for (uint64_t i = 1; i < span; ++i) {
+            if (cell(pos + i).seq.load(std::memory_order_acquire) != pos + i + 1) return false;
+        }
+        return true;
+    }
+    inline void release(uint64_t pos, uint64_t span) {  // 按顺序释放单元给下一圈, 并推进读位置
+        for (uint64_t i = 0; i < span; ++i) {
+            cell(pos + i).seq.store(pos + i + header->capacity, std::memory_order_release);
+        }
+        header->dequeuePos.store(pos + span, std::memory_order_release);
+    }
+
+    std::string shmName;            // 共享内存段名称
+    uint64_t pendingSpan = 0;       // peek 返回的日志占用的单元数
+    uint64_t skippedCells = 0;      // 跳过的单元数
+};
+
+#endif // LOGGER_SHM_H
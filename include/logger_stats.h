@@ -0,0 +1,89 @@
+#ifndef LOGGER_STATS_H
+#define LOGGER_STATS_H
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// 延迟直方图桶数: 桶 0 为 0ns, 桶 i(i>0) 为 [2^(i-1), 2^i) 纳秒, 最后一个桶收纳更大的值
+#define LOG_HISTOGRAM_BUCKETS 40
+
+// 直方图快照(可拷贝, 供调用方分析)
+struct LogHistogramSnapshot {
+    uint64_t count;                             // 样本数
+    uint64_t sum;                               // 样本总和(纳秒)
+    uint64_t max;                               // 最大值(纳秒)
+    uint64_t buckets[LOG_HISTOGRAM_BUCKETS];    // 各桶样本数
+
+    inline double mean() const {
+        return count ? static_cast<double>(sum) / count : 0.0;
+    }
+    // 百分位(p 取 0~1), 返回所在桶的上界(纳秒), 不超过最大值
+    inline uint64_t percentile(double p) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < LOG_HISTOGRAM_BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint64_t upper = i == 0 ? 0 : (1ULL << i) - 1;
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+};
+
+// 以 2 的幂分桶的延迟直方图
+// 单写者(日志线程)用 relaxed 读改写, 其他线程可随时取快照, 不引入锁或原子 RMW 竞争
+class LogHistogram {
+public:
+    LogHistogram() {
+        reset();
+    }
+
+    inline void record(uint64_t nanos) {
+        bump(buckets[bucketOf(nanos)], 1);
+        bump(count, 1);
+        bump(sum, nanos);
+        if (nanos > max.load(std::memory_order_relaxed)) max.store(nanos, std::memory_order_relaxed);
+    }
+    inline LogHistogramSnapshot snapshot() const {
+        LogHistogramSnapshot s;
+        for (int i = 0; i < LOG_HISTOGRAM_BUCKETS; ++i) s.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        s.count = count.load(std::memory_order_relaxed);
+        s.sum = sum.load(std::memory_order_relaxed);
+        s.max = max.load(std::memory_order_relaxed);
+        return s;
+    }
+    inline void reset() {
+        for (int i = 0; i < LOG_HISTOGRAM_BUCKETS; ++i) buckets[i].store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static inline void bump(std::atomic<uint64_t>& counter, uint64_t n) {  // 单写者自增, 不需要 lock 前缀
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    static inline int bucketOf(uint64_t nanos) {
+        if (nanos == 0) return 0;
+#if defined(__GNUC__)
+        int bits = 64 - __builtin_clzll(nanos);
+#else
+        int bits = 0;
+        while (nanos) {
+            ++bits;
+            nanos >>= 1;
+        }
+#endif
+        return bits < LOG_HISTOGRAM_BUCKETS ? bits : LOG_HISTOGRAM_BUCKETS - 1;
+    }
+
+    std::atomic<uint64_t> buckets[LOG_HISTOGRAM_BUCKETS];   // 各桶样本数
+    std::atomic<uint64_t> count;    // 样本数
+    std::atomic<uint64_t> sum;      // 样本总和
+    std::atomic<uint64_t> max;      // 最大值
+};
+
+#endif // LOGGER_STATS_H
@@ -0,0 +1,174 @@
+#ifndef LOGGER_TIME_H
+#define LOGGER_TIME_H
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <chrono>
+#include <thread>
+#if defined(LOGGER_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define LOGGER_HAS_TSC 1
+#else
+#define LOGGER_HAS_TSC 0
+#endif
+
+// 时间戳精度
+enum LogTimePrecision {
+    LOG_TIME_SEC,   // 秒:   2025-04-01 12:00:00
+    LOG_TIME_MS,    // 毫秒: 2025-04-01 12:00:00.123
+    LOG_TIME_US,    // 微秒: 2025-04-01 12:00:00.123456
+    LOG_TIME_NS,    // 纳秒: 2025-04-01 12:00:00.123456789
+};
+
+// 日志时钟: 调用点只采样原始时钟值, 由日志线程换算为纳秒
+// 默认使用 system_clock(纳秒); 定义 LOGGER_USE_TSC 时在 x86 上使用 rdtsc, 启动时对齐到系统时间
+class LogClock {
+public:
+    static inline uint64_t raw() {   // 调用点采样
+#if LOGGER_HAS_TSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+#endif
+    }
+    static inline int64_t toNanos(uint64_t raw) {   // 原始值换算为纪元纳秒
+#if LOGGER_HAS_TSC
+        const Calibration& c = calibration();
+        return c.baseNanos + static_cast<int64_t>((static_cast<int64_t>(raw - c.baseTicks)) * c.nanosPerTick);
+#else
+        return static_cast<int64_t>(raw);
+#endif
+    }
+    static inline uint64_t fromNanos(int64_t nanos) {   // 纪元纳秒换算为原始值(toNanos 的逆运算, 用于外部传入的时间)
+#if LOGGER_HAS_TSC
+        const Calibration& c = calibration();
+        return c.baseTicks + static_cast<uint64_t>(static_cast<int64_t>((nanos - c.baseNanos) / c.nanosPerTick));
+#else
+        return static_cast<uint64_t>(nanos);
+#endif
+    }
+    static inline int64_t nowNanos() {
+        return toNanos(raw());
+    }
+    static inline void calibrate() {    // 提前完成 TSC 校准(Logger::start 中调用)
+#if LOGGER_HAS_TSC
+        calibration();
+#endif
+    }
+
+private:
+#if LOGGER_HAS_TSC
+    struct Calibration {
+        uint64_t baseTicks;     // 校准时的 TSC 值
+        int64_t baseNanos;      // 校准时的系统时间
+        double nanosPerTick;    // 每个 TSC 周期的纳秒数
+    };
+    static inline int64_t systemNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    static inline Calibration measure() {
+        int64_t t0 = systemNanos();
+        uint64_t c0 = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        int64_t t1 = systemNanos();
+        uint64_t c1 = __rdtsc();
+        Calibration c;
+        c.baseTicks = c1;
+        c.baseNanos = t1;
+        c.nanosPerTick = c1 > c0 ? static_cast<double>(t1 - t0) / static_cast<double>(c1 - c0) : 1.0;
+        return c;
+    }
+    static inline const Calibration& calibration() {
+        static const Calibration c = measure();
+        return c;
+    }
+#endif
+};
+
+// 时间戳格式化(仅由单个线程使用)
+// 缓存 "YYYY-MM-DD HH:MM:SS" 前缀, 秒数变化时才调用 localtime/strftime
+class LogTimeFormatter {
+public:
+    static const size_t MAX_LENGTH = 32;   // 输出最大长度(含结尾 '\0')
+
+    explicit LogTimeFormatter(LogTimePrecision precision = LOG_TIME_MS) : precision(precision) {}
+
+    inline void setPrecision(LogTimePrecision p) { precision = p; }
+    inline LogTimePrecision getPrecision() const { return precision; }
+
+    // 格式化纪元纳秒, 写入 out(至少 MAX_LENGTH 字节), 返回长度
+    inline size_t format(int64_t nanos, char* out) {
+        int64_t sec = floorDiv(nanos, 1000000000LL);
+        if (sec != cachedSecond) {
+            std::time_t t = static_cast<std::time_t>(sec);
+            std::tm tm_snapshot;
+            toLocalTime(t, tm_snapshot);
+            prefixLength = std::strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &tm_snapshot);
+            cachedSecond = sec;
+        }
+        std::memcpy(out, prefix, prefixLength);
+        size_t len = prefixLength;
+        uint32_t frac = static_cast<uint32_t>(nanos - sec * 1000000000LL);
+        switch (precision) {
+            case LOG_TIME_MS: len += writeFraction(out + len, frac / 1000000, 3); break;
+            case LOG_TIME_US: len += writeFraction(out + len, frac / 1000, 6); break;
+            case LOG_TIME_NS: len += writeFraction(out + len, frac, 9); break;
+            default: break;
+        }
+        out[len] = '\0';
+        return len;
+    }
+
+    // 计算 nanos 所在本地日期的下一个零点(纪元纳秒), 用于按天切换日志文件
+    static inline int64_t nextMidnight(int64_t nanos) {
+        std::time_t t = static_cast<std::time_t>(floorDiv(nanos, 1000000000LL));
+        std::tm tm_snapshot;
+        toLocalTime(t, tm_snapshot);
+        tm_snapshot.tm_hour = 0;
+        tm_snapshot.tm_min = 0;
+        tm_snapshot.tm_sec = 0;
+        tm_snapshot.tm_mday += 1;
+        tm_snapshot.tm_isdst = -1;
+        return static_cast<int64_t>(std::mktime(&tm_snapshot)) * 1000000000LL;
+    }
+
+    // 格式化 nanos 所在的本地日期 "YYYY-MM-DD"
+    static inline std::string date(int64_t nanos) {
+        std::time_t t = static_cast<std::time_t>(floorDiv(nanos, 1000000000LL));
+        std::tm tm_snapshot;
+        toLocalTime(t, tm_snapshot);
+        char buffer[16] = {0};
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm_snapshot);
+        return std::string(buffer);
+    }
+
+private:
+    static inline int64_t floorDiv(int64_t a, int64_t b) {
+        return a >= 0 ? a / b : -((-a + b - 1) / b);
+    }
+    static inline void toLocalTime(std::time_t t, std::tm& out) {
+#if defined(_WIN32) || defined(_WIN64)
+        localtime_s(&out, &t);
+#else
+        localtime_r(&t, &out);  // 线程安全版本
+#endif
+    }
+    static inline size_t writeFraction(char* out, uint32_t value, int digits) {
+        out[0] = '.';
+        for (int i = digits; i > 0; --i) {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        return digits + 1;
+    }
+
+    LogTimePrecision precision;         // 输出精度
+    int64_t cachedSecond = INT64_MIN;   // 缓存前缀对应的秒
+    size_t prefixLength = 0;            // 缓存前缀长度
+    char prefix[24];                    // 缓存的 "YYYY-MM-DD HH:MM:SS"
+};
+
+#endif // LOGGER_TIME_H
@@ -0,0 +1,127 @@
+#ifndef LOGGER_WAIT_H
+#define LOGGER_WAIT_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// 日志线程空闲等待: 先自旋 LOG_WAIT_SPIN 次(单核时不自旋), 再让出 CPU LOG_WAIT_YIELD 次, 仍无日志时休眠
+// Linux 下休眠在 futex 上, 其他平台使用条件变量; 休眠有超时, 供刷盘周期、统计等定时任务使用
+#ifndef LOG_WAIT_SPIN
+#define LOG_WAIT_SPIN 2000
+#endif
+#ifndef LOG_WAIT_YIELD
+#define LOG_WAIT_YIELD 20
+#endif
+// 没有定时任务时的最长休眠时间(毫秒)
+#ifndef LOG_WAIT_PARK_MS
+#define LOG_WAIT_PARK_MS 1000
+#endif
+
+// 日志线程等待方式
+enum LogWaitMode {
+    LOG_WAIT_ADAPTIVE,  // 自旋 -> 让出 -> 休眠, 生产者在日志线程休眠时唤醒(默认)
+    LOG_WAIT_POLL,      // 每轮固定休眠 10 毫秒(旧方式)
+};
+
+static inline void logCpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// 单消费者的等待/唤醒
+// 休眠前先置 parked 再复查是否有日志, 生产者先发布再检查 parked, 两边之间各有一次全屏障, 不会丢失唤醒;
+// 生产者在日志线程未休眠时只多一次屏障和一次原子读, 不进入内核
+class LogWaiter {
+public:
+    LogWaiter(const LogWaiter&) = delete;
+    LogWaiter& operator=(const LogWaiter&) = delete;
+    LogWaiter() : spinLimit(std::thread::hardware_concurrency() > 1 ? LOG_WAIT_SPIN : 0) {}
+
+    // 日志线程: 等待 ready() 为真或超时, 返回 ready() 的结果
+    template <typename Ready>
+    inline bool wait(Ready ready, int timeoutMs) {
+        for (int i = 0; i < spinLimit; ++i) {
+            if (ready()) return true;
+            logCpuRelax();
+        }
+        for (int i = 0; i < LOG_WAIT_YIELD; ++i) {
+            if (ready()) return true;
+            std::this_thread::yield();
+        }
+        uint32_t seen = epoch.load(std::memory_order_acquire);
+        parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) {
+            parks.fetch_add(1, std::memory_order_relaxed);
+            sleep(seen, timeoutMs);
+        }
+        parked.store(false, std::memory_order_relaxed);
+        return ready();
+    }
+    // 生产者: 发布日志后调用, 只有日志线程已休眠时才唤醒
+    inline void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed)) wake();
+    }
+    // 无条件唤醒(flush、停止、配置变化); Linux 下异步信号安全
+    inline void wake() {
+        epoch.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_one();
+#endif
+    }
+    // 信号处理函数中唤醒: Linux 下同 wake, 其他平台不能加锁, 只更新计数, 由休眠超时处理
+    inline void wakeFromSignal() {
+#if defined(__linux__)
+        wake();
+#else
+        epoch.fetch_add(1, std::memory_order_release);
+#endif
+    }
+    inline uint64_t parkCount() const { return parks.load(std::memory_order_relaxed); }  // 休眠次数
+
+private:
+    inline void sleep(uint32_t seen, int timeoutMs) {   // epoch 仍为 seen 时休眠
+#if defined(__linux__)
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, seen, &timeout, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]() {
+            return epoch.load(std::memory_order_acquire) != seen;
+        });
+#endif
+    }
+
+    const int spinLimit;                // 自旋次数(单核时自旋只会占用生产者的 CPU)
+    std::atomic<uint32_t> epoch{0};     // 唤醒计数(futex 字)
+    std::atomic<bool> parked{false};    // 日志线程是否准备休眠
+    std::atomic<uint64_t> parks{0};     // 休眠次数(统计)
+#if !defined(__linux__)
+    std::mutex mtx;
+    std::condition_variable cv;
+#endif
+};
+
+#endif // LOGGER_WAIT_H
@@ -0,0 +1,112 @@
+#ifndef LOGGER_WATCH_H
+#define LOGGER_WATCH_H
+#include <string>
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// 配置文件监视: Linux 下用 inotify 监视配置文件所在目录, 文件写完(close)、被改名替换或修改时间变化时立即返回;
+// 监视目录而不是文件本身, 编辑器"写临时文件再改名"的保存方式也能收到通知
+// 其他平台或 inotify 不可用时 open 返回 false, 由调用方按周期检查修改时间
+class LogConfigWatcher {
+public:
+    LogConfigWatcher(const LogConfigWatcher&) = delete;
+    LogConfigWatcher& operator=(const LogConfigWatcher&) = delete;
+    LogConfigWatcher() {}
+    ~LogConfigWatcher() {
+        close();
+    }
+
+    inline bool open(const std::string& path) {
+        close();
+#if defined(__linux__)
+        std::string::size_type slash = path.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+        name = slash == std::string::npos ? path : path.substr(slash + 1);
+        notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (notifyFd < 0 || stopFd < 0 ||
+            inotify_add_watch(notifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB) < 0) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+    inline bool isOpen() const { return notifyFd >= 0; }
+    inline void close() {
+#if defined(__linux__)
+        if (notifyFd >= 0) ::close(notifyFd);
+        if (stopFd >= 0) ::close(stopFd);
+#endif
+        notifyFd = -1;
+        stopFd = -1;
+    }
+
+    // 等待配置文件变化: 返回 true 表示文件有变化, false 表示被 interrupt 唤醒或出错
+    inline bool wait() {
+#if defined(__linux__)
+        for (;;) {
+            struct pollfd fds[2];
+            fds[0].fd = notifyFd;
+            fds[0].events = POLLIN;
+            fds[1].fd = stopFd;
+            fds[1].events = POLLIN;
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (fds[1].revents != 0) {
+                uint64_t value;
+                ssize_t ignored = read(stopFd, &value, sizeof(value));
+                (void)ignored;
+                return false;
+            }
+            if (readEvents()) return true;
+        }
+#else
+        return false;
+#endif
+    }
+    inline void interrupt() {   // 唤醒 wait(停止时调用)
+#if defined(__linux__)
+        if (stopFd >= 0) {
+            uint64_t one = 1;
+            ssize_t ignored = write(stopFd, &one, sizeof(one));
+            (void)ignored;
+        }
+#endif
+    }
+
+private:
+#if defined(__linux__)
+    inline bool readEvents() {  // 读出全部事件, 返回其中是否有配置文件
+        bool changed = false;
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t n;
+        while ((n = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + n;) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                if (event->len > 0 && name == event->name) changed = true;
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+#endif
+
+    std::string name;       // 配置文件名(不含目录)
+    int notifyFd = -1;      // inotify 描述符
+    int stopFd = -1;        // 停止通知(eventfd)
+};
+
+#endif // LOGGER_WATCH_H
@@ -0,0 +1,585 @@
+#ifndef LOGGER_WRITER_H
+#define LOGGER_WRITER_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include "logger_stats.h"
+#include "logger_index.h"
+#if defined(LOGGER_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+// 日志文件写缓冲区大小
+#ifndef LOG_WRITE_BUFFER_SIZE
+#define LOG_WRITE_BUFFER_SIZE (1024 * 1024)
+#endif
+
+// mmap 输出方式每次预先扩展文件并映射的大小
+#ifndef LOG_MMAP_CHUNK_SIZE
+#define LOG_MMAP_CHUNK_SIZE (16 * 1024 * 1024)
+#endif
+// mmap 输出方式记录文件逻辑长度的旁路文件后缀(<日志文件>.len, 正常关闭时删除)
+#define LOG_MMAP_LENGTH_SUFFIX ".len"
+
+// 流式压缩时每帧(独立的 gzip 成员)的未压缩大小上限和压缩级别
+#ifndef LOG_COMPRESS_FRAME_SIZE
+#define LOG_COMPRESS_FRAME_SIZE (64 * 1024)
+#endif
+#ifndef LOG_COMPRESS_LEVEL
+#define LOG_COMPRESS_LEVEL 1
+#endif
+
+// 日志文件输出方式
+enum LogFileSink {
+    LOG_SINK_WRITE,         // 写缓冲区 + write 系统调用, 默认
+    LOG_SINK_MMAP,          // 文件按块预先扩展并映射, 日志行直接写入映射区(Windows 下退回 write)
+};
+
+// 刷盘(调用 write)策略
+enum LogFlushMode {
+    LOG_FLUSH_BATCH,        // 每批(日志线程一次取空队列)写一次, 默认
+    LOG_FLUSH_MESSAGE,      // 每条日志写一次
+    LOG_FLUSH_BYTES,        // 缓冲区累计 bytes 字节写一次
+    LOG_FLUSH_INTERVAL,     // 每 intervalMs 毫秒写一次
+    LOG_FLUSH_LEVEL,        // 出现 level 及以上级别的日志时写一次
+};
+
+struct LogFlushPolicy {
+    LogFlushMode mode = LOG_FLUSH_BATCH;
+    size_t bytes = 64 * 1024;   // LOG_FLUSH_BYTES 的阈值
+    int intervalMs = 1000;      // LOG_FLUSH_INTERVAL 的周期; 也是 BYTES/LEVEL 模式下数据在缓冲区的最长停留时间
+    int level = 3;              // LOG_FLUSH_LEVEL 的级别阈值(默认 WARN)
+};
+
+// 写入统计
+struct LogWriterStats {
+    uint64_t syscalls;          // write 系统调用次数
+    uint64_t bytes;             // 写入字节数
+    uint64_t batches;           // 刷盘批次数
+    double syscallsPerSec;      // 自上次取统计以来每秒系统调用次数
+    double avgBatchBytes;       // 平均每批字节数
+};
+
+// 批量文件写入器(仅由日志线程使用, 统计计数可被其他线程读取)
+// 日志行先追加到连续缓冲区, 按刷盘策略合并为一次 write 调用
+// mmap 方式下日志行直接写入文件映射区, 刷盘改为 msync, 关闭时把文件截断到实际长度;
+// 逻辑长度同时记录在映射的 <文件>.len 中, 异常退出后下次打开时据此截掉预先扩展的部分
+// 流式压缩方式下缓冲区即当前帧: 满 LOG_COMPRESS_FRAME_SIZE、刷盘或 batch 策略下停留超过 intervalMs 时压缩为一个 gzip 成员写出,
+// 并在 <文件>.idx 中记录该帧的偏移、长度、时间范围和级别; 文件整体仍可用 zcat 读取
+class LogFileWriter {
+public:
+    LogFileWriter(const LogFileWriter&) = delete;
+    LogFileWriter& operator=(const LogFileWriter&) = delete;
+    LogFileWriter() : buffer(LOG_WRITE_BUFFER_SIZE) {
+        lastSampleNanos = steadyNanos();
+    }
+    ~LogFileWriter() {
+        close();
+#if defined(LOGGER_HAVE_ZLIB)
+        if (zstreamReady) deflateEnd(&zstream);
+#endif
+    }
+
+    inline bool open(const std::string& path) {
+        close();
+        owned = true;
+        compressing = compression && openCompressed(path);
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (sink == LOG_SINK_MMAP && !compressing) return openMapped(path);
+#endif
+#if defined(_WIN32) || defined(_WIN64)
+        handle = CreateFile(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (handle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        fileBytes = GetFileSizeEx(handle, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+        return true;
+#else
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        struct stat st;
+        fileBytes = fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+        return true;
+#endif
+    }
+    // 绑定标准输出(不拥有句柄, close 时只刷出缓冲区)
+    inline bool attachStdout() {
+        close();
+        owned = false;
+#if defined(_WIN32) || defined(_WIN64)
+        handle = GetStdHandle(STD_OUTPUT_HANDLE);
+        return handle != INVALID_HANDLE_VALUE;
+#else
+        fd = STDOUT_FILENO;
+        return true;
+#endif
+    }
+    // 打开日志文件之前修复上次 mmap 方式异常退出留下的文件末尾: 按 <文件>.len 记录的逻辑长度截断后删除该文件
+    // 没有 .len 文件(正常关闭或未使用 mmap 方式)时不做任何事
+    static inline void repairFile(const std::string& path) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        std::string lengthPath = path + LOG_MMAP_LENGTH_SUFFIX;
+        int mark = ::open(lengthPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (mark < 0) return;
+        uint64_t length = 0;
+        bool valid = ::pread(mark, &length, sizeof(length), 0) == static_cast<ssize_t>(sizeof(length));
+        ::close(mark);
+        int file = valid ? ::open(path.c_str(), O_RDWR | O_CLOEXEC) : -1;   // 记录不完整时文件尚未预先扩展
+        if (file >= 0) {
+            struct stat st;
+            if (fstat(file, &st) == 0 && length < static_cast<uint64_t>(st.st_size) &&
+                ::ftruncate(file, static_cast<off_t>(length)) != 0) valid = false;
+            ::close(file);
+            if (!valid) return;     // 截断失败时保留记录, 下次再试
+        }
+        ::unlink(lengthPath.c_str());
+#else
+        (void)path;
+#endif
+    }
+    // 当前输出是否为终端(用于自动关闭 ANSI 颜色)
+    inline bool isTerminal() const {
+#if defined(_WIN32) || defined(_WIN64)
+        DWORD mode = 0;
+        return handle != INVALID_HANDLE_VALUE && GetConsoleMode(handle, &mode);
+#else
+        return fd >= 0 && isatty(fd);
+#endif
+    }
+    inline bool isOpen() const {
+#if defined(_WIN32) || defined(_WIN64)
+        return handle != INVALID_HANDLE_VALUE;
+#else
+        return fd >= 0;
+#endif
+    }
+    inline void close() {
+        if (!isOpen()) return;
+        flush();
+#if defined(_WIN32) || defined(_WIN64)
+        if (owned) {
+            FlushFileBuffers(handle);
+            CloseHandle(handle);
+        }
+        handle = INVALID_HANDLE_VALUE;
+#else
+        if (mapped) closeMapped();
+        if (lengthMark != nullptr) {    // 未能截断(退回 write 方式时): 保留 .len, 下次打开时修复
+            munmap(lengthMark, sizeof(uint64_t));
+            lengthMark = nullptr;
+        }
+        if (owned) ::close(fd);
+        fd = -1;
+#endif
+        frameIndex.close(fileBytes);
+        compressing = false;
+    }
+
+    inline void setPolicy(const LogFlushPolicy& p) { policy = p; }
+    inline const LogFlushPolicy& getPolicy() const { return policy; }
+    inline void setSink(LogFileSink s) { sink = s; }   // 下次 open 时生效
+    inline LogFileSink getSink() const { return sink; }
+    inline void setCompression(bool on) {   // 流式压缩(需要 zlib), 下次 open 时生效
+#if defined(LOGGER_HAVE_ZLIB)
+        compression = on;
+#else
+        (void)on;
+#endif
+    }
+    inline bool getCompression() const { return compression; }
+    // 流式压缩方式下当前帧为空(下一条记录开始新的帧), 二进制格式需要在帧开头写入文件头
+    inline bool frameBoundary() const { return compressing && used == 0; }
+
+    // 接下来要连续写入最多 n 字节(如文件头和一条记录): 缓冲区放不下时先刷盘并按需扩大, 使它们落在同一压缩帧中
+    inline void prepare(size_t n) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (mapped) return;
+#endif
+        if (used + n <= buffer.size()) return;
+        flush();
+        if (n > buffer.size()) buffer.resize(n);
+    }
+    // 预留 n 字节的写入空间, 写完后调用 commit; 缓冲区不足时先刷盘
+    inline char* reserve(size_t n) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (mapped) {
+            if (mapBase == nullptr || fileBytes + n > mapOffset + mapSize) remap(n);
+            if (mapped) return mapBase + (fileBytes - mapOffset);
+        }
+#endif
+        if (used + n > buffer.size()) {
+            flush();
+            if (n > buffer.size()) buffer.resize(n);
+        }
+        return &buffer[used];
+    }
+    // 提交 reserve 得到的空间中实际写入的 n 字节; nanos 为日志时间(流式压缩时记入帧索引, 文件头等非日志内容不传)
+    inline void commit(size_t n, int level, int64_t nanos = INT64_MIN) {
+        if (used == 0) {
+            firstPendingNanos = steadyNanos();
+            if (compressing) frameIndex.startBlock(fileBytes);
+        }
+        used += n;
+        fileBytes += n;
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (lengthMark != nullptr) *lengthMark = fileBytes;
+#endif
+        if (compressing && nanos != INT64_MIN) frameIndex.add(nanos, level);
+        switch (policy.mode) {
+            case LOG_FLUSH_MESSAGE: flush(); break;
+            case LOG_FLUSH_BYTES: if (used >= policy.bytes) flush(); break;
+            case LOG_FLUSH_LEVEL: if (level >= policy.level) flush(); break;
+            default: break;
+        }
+        if (compressing && used >= LOG_COMPRESS_FRAME_SIZE) flush();
+    }
+    inline void append(const char* data, size_t n, int level) {
+        std::memcpy(reserve(n), data, n);
+        commit(n, level);
+    }
+    // 一批日志处理完毕(或日志线程空闲)时调用, 按策略决定是否刷盘
+    inline void onBatchEnd() {
+        if (used == 0) return;
+        if (policy.mode == LOG_FLUSH_BATCH && !compressing) {   // 流式压缩时不按批切帧, 避免帧过小
+            flush();
+        } else if (policy.mode != LOG_FLUSH_MESSAGE) {
+            int64_t waited = steadyNanos() - firstPendingNanos;
+            if (waited >= static_cast<int64_t>(policy.intervalMs) * 1000000LL) flush();
+        }
+    }
+    // 把缓冲区内容一次性写入文件
+    inline void flush() {
+        if (used == 0) return;
+        if (compressing) {
+            writeFrame(true);
+            return;
+        }
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (mapped) {
+            syncMapped(MS_ASYNC);
+            return;
+        }
+#endif
+        if (isOpen()) writeAll(&buffer[0], used);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        used = 0;
+    }
+    // 崩溃转储开始时写出缓冲区(异步信号安全: 压缩帧不更新索引文件, 查询时按未索引部分扫描)
+    // mmap 方式下数据已在映射区(页缓存)中, 进程退出后由内核回写, 不调用 msync
+    inline void flushForCrash() {
+        if (compressing) {
+            writeFrame(false);
+            return;
+        }
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (mapped) return;
+#endif
+        flush();
+    }
+    // 绕过缓冲区直接写入文件(崩溃转储使用, 不分配内存、不加锁); 流式压缩方式下追加到当前帧, 帧满时压缩写出
+    // mmap 方式下不重新映射: 当前窗口放不下时改用 pwrite
+    inline void writeRaw(const char* data, size_t n) {
+        while (compressing && n > 0) {
+            if (used == buffer.size()) writeFrame(false);
+            size_t k = n < buffer.size() - used ? n : buffer.size() - used;
+            std::memcpy(&buffer[used], data, k);
+            used += k;
+            fileBytes += k;
+            data += k;
+            n -= k;
+        }
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (mapped) {   // 映射区放得下就直接拷贝, 否则在逻辑末尾 pwrite
+            if (mapBase != nullptr && fileBytes + n <= mapOffset + mapSize) {
+                std::memcpy(mapBase + (fileBytes - mapOffset), data, n);
+            } else {
+                uint64_t offset = fileBytes;
+                size_t left = n;
+                while (left > 0) {
+                    ssize_t written = ::pwrite(fd, data, left, static_cast<off_t>(offset));
+                    if (written < 0 && errno == EINTR) continue;
+                    if (written <= 0) break;
+                    data += written;
+                    offset += written;
+                    left -= written;
+                }
+                n -= left;
+            }
+            fileBytes += n;
+            if (lengthMark != nullptr) *lengthMark = fileBytes;
+            return;
+        }
+#endif
+        if (isOpen()) writeAll(data, n);
+    }
+    // 把已预先扩展的文件截断到实际长度, 流式压缩方式下写出最后一帧(崩溃转储结束时调用, 异步信号安全)
+    inline void trim() {
+        if (compressing) writeFrame(false);
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (!mapped) return;
+        if (::ftruncate(fd, static_cast<off_t>(fileBytes)) == 0) allocatedBytes = fileBytes;
+#endif
+    }
+    inline size_t pending() const { return used; }
+    inline uint64_t currentSize() const { return fileBytes; }  // 当前文件大小(含缓冲区中未写出的部分, 流式压缩时当前帧按未压缩大小计)
+
+    // 获取统计信息, 每秒系统调用次数按两次调用之间的间隔计算
+    // 用户线程(Logger::stats)和日志线程(周期统计)都会调用, 采样状态由 sampleMtx 保护(不在写入路径上)
+    inline LogWriterStats stats() {
+        std::lock_guard<std::mutex> lock(sampleMtx);
+        LogWriterStats s;
+        s.syscalls = syscalls.load(std::memory_order_relaxed);
+        s.bytes = bytesWritten.load(std::memory_order_relaxed);
+        s.batches = batches.load(std::memory_order_relaxed);
+        int64_t now = steadyNanos();
+        double seconds = (now - lastSampleNanos) / 1e9;
+        s.syscallsPerSec = seconds > 0 ? (s.syscalls - lastSampleSyscalls) / seconds : 0.0;
+        s.avgBatchBytes = s.batches ? static_cast<double>(s.bytes) / s.batches : 0.0;
+        lastSampleNanos = now;
+        lastSampleSyscalls = s.syscalls;
+        return s;
+    }
+    inline LogHistogramSnapshot syscallLatency() const {   // write 系统调用耗时分布
+        return writeLatency.snapshot();
+    }
+
+private:
+    static inline int64_t steadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    inline void writeAll(const char* data, size_t n) {
+        while (n > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+            DWORD written = 0;
+            int64_t begin = steadyNanos();
+            BOOL ok = WriteFile(handle, data, static_cast<DWORD>(n), &written, NULL);
+            writeLatency.record(steadyNanos() - begin);
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+            if (!ok) return;
+#else
+            int64_t begin = steadyNanos();
+            ssize_t written = ::write(fd, data, n);
+            writeLatency.record(steadyNanos() - begin);
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return;     // 写失败(如磁盘满)时丢弃本批, 不阻塞日志线程
+            }
+#endif
+            bytesWritten.fetch_add(written, std::memory_order_relaxed);
+            data += written;
+            n -= written;
+        }
+    }
+
+    inline bool openCompressed(const std::string& path) {  // 准备压缩流和帧索引(压缩流只初始化一次, 之后每帧 deflateReset)
+#if defined(LOGGER_HAVE_ZLIB)
+        if (!zstreamReady) {
+            std::memset(&zstream, 0, sizeof(zstream));
+            if (deflateInit2(&zstream, LOG_COMPRESS_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+            zstreamReady = true;
+        }
+        frameOut.resize(deflateBound(&zstream, static_cast<uLong>(buffer.size())));
+        if (!frameIndex.open(path + ".idx", 0)) return false;
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+    // 把缓冲区压缩为一个 gzip 成员写出; 压缩失败时丢弃本帧
+    // 日志线程调用时按需扩大输出缓冲区并更新帧索引, 崩溃转储时不分配内存、不写索引
+    inline void writeFrame(bool updateIndex) {
+        if (used == 0) return;
+#if defined(LOGGER_HAVE_ZLIB)
+        if (updateIndex && frameOut.size() < deflateBound(&zstream, static_cast<uLong>(used))) {
+            frameOut.resize(deflateBound(&zstream, static_cast<uLong>(used)));
+        }
+        deflateReset(&zstream);
+        zstream.next_in = reinterpret_cast<Bytef*>(&buffer[0]);
+        zstream.avail_in = static_cast<uInt>(used);
+        zstream.next_out = reinterpret_cast<Bytef*>(&frameOut[0]);
+        zstream.avail_out = static_cast<uInt>(frameOut.size());
+        fileBytes -= used;
+        if (deflate(&zstream, Z_FINISH) == Z_STREAM_END) {
+            size_t n = frameOut.size() - zstream.avail_out;
+            writeAll(&frameOut[0], n);
+            fileBytes += n;
+        }
+        if (updateIndex) frameIndex.endBlock(fileBytes);
+#else
+        (void)updateIndex;
+#endif
+        batches.fetch_add(1, std::memory_order_relaxed);
+        used = 0;
+    }
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    // 打开前由调用方 repairFile; 逻辑长度记录文件无法建立时退回 write 方式
+    inline bool openMapped(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        struct stat st;
+        fileBytes = fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+        allocatedBytes = fileBytes;
+        syncedBytes = fileBytes;
+        pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        mapped = openLengthMark(path + LOG_MMAP_LENGTH_SUFFIX);
+        if (!mapped) lseek(fd, static_cast<off_t>(fileBytes), SEEK_SET);
+        return true;
+    }
+    // 建立并映射逻辑长度记录文件: 先写入当前长度再映射, 之后每次提交更新(进程被杀死后仍在页缓存中)
+    inline bool openLengthMark(const std::string& path) {
+        int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (file < 0) return false;
+        void* base = MAP_FAILED;
+        if (::pwrite(file, &fileBytes, sizeof(fileBytes), 0) == static_cast<ssize_t>(sizeof(fileBytes))) {
+            base = mmap(nullptr, sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        }
+        ::close(file);
+        if (base == MAP_FAILED) {
+            ::unlink(path.c_str());
+            return false;
+        }
+        lengthMark = static_cast<uint64_t*>(base);
+        lengthPath = path;
+        return true;
+    }
+    inline void closeLengthMark() {    // 文件已截断到实际长度后删除记录
+        if (lengthMark == nullptr) return;
+        munmap(lengthMark, sizeof(uint64_t));
+        lengthMark = nullptr;
+        ::unlink(lengthPath.c_str());
+    }
+    // 映射包含 [fileBytes, fileBytes + n) 的新窗口, 文件按 LOG_MMAP_CHUNK_SIZE 预先扩展
+    // 扩展或映射失败(如磁盘满)时截断文件并退回 write 方式
+    inline void remap(size_t n) {
+        unmap();
+        size_t page = pageSize;
+        uint64_t offset = fileBytes / page * page;
+        size_t size = static_cast<size_t>(fileBytes - offset) + n;
+        if (size < LOG_MMAP_CHUNK_SIZE) size = LOG_MMAP_CHUNK_SIZE;
+        size = (size + page - 1) / page * page;
+        if (offset + size > allocatedBytes) {
+            int64_t begin = steadyNanos();
+            bool ok = extend(offset + size);
+            writeLatency.record(steadyNanos() - begin);
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+            if (!ok) {
+                fallback();
+                return;
+            }
+        }
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(offset));
+        if (base == MAP_FAILED) {
+            fallback();
+            return;
+        }
+        madvise(base, size, MADV_SEQUENTIAL);
+        mapBase = static_cast<char*>(base);
+        mapOffset = offset;
+        mapSize = size;
+    }
+    inline bool extend(uint64_t length) {  // 预先分配磁盘空间, 避免写入映射区时因磁盘满触发 SIGBUS
+#if defined(__linux__)
+        int err = posix_fallocate(fd, static_cast<off_t>(allocatedBytes), static_cast<off_t>(length - allocatedBytes));
+        if (err != 0 && err != EOPNOTSUPP && err != EINVAL) return false;
+        if (err != 0 && ::ftruncate(fd, static_cast<off_t>(length)) != 0) return false;
+#else
+        if (::ftruncate(fd, static_cast<off_t>(length)) != 0) return false;
+#endif
+        allocatedBytes = length;
+        return true;
+    }
+    inline void syncMapped(int flags) {    // msync 未同步的部分(只限当前窗口, 已解除映射的窗口由内核回写)
+        if (mapBase != nullptr && fileBytes > mapOffset) {
+            size_t page = pageSize;
+            uint64_t from = syncedBytes > mapOffset ? syncedBytes / page * page : mapOffset;
+            int64_t begin = steadyNanos();
+            msync(mapBase + (from - mapOffset), static_cast<size_t>(fileBytes - from), flags);
+            writeLatency.record(steadyNanos() - begin);
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+        }
+        bytesWritten.fetch_add(fileBytes - syncedBytes, std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        syncedBytes = fileBytes;
+        used = 0;
+    }
+    inline void unmap() {
+        if (mapBase == nullptr) return;
+        munmap(mapBase, mapSize);
+        mapBase = nullptr;
+        mapSize = 0;
+    }
+    inline void fallback() {   // 退回 write 方式: 截断预先扩展的部分, 文件偏移移到末尾继续追加
+        unmap();
+        if (::ftruncate(fd, static_cast<off_t>(fileBytes)) == 0) allocatedBytes = fileBytes;
+        lseek(fd, static_cast<off_t>(fileBytes), SEEK_SET);
+        syncedBytes = fileBytes;
+        used = 0;
+        mapped = false;
+        if (allocatedBytes == fileBytes) closeLengthMark();
+    }
+    inline void closeMapped() {
+        unmap();
+        if (::ftruncate(fd, static_cast<off_t>(fileBytes)) == 0) {   // 截断到实际长度
+            allocatedBytes = fileBytes;
+            closeLengthMark();
+        }
+        mapped = false;
+    }
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE handle = INVALID_HANDLE_VALUE;   // 日志文件句柄
+#else
+    int fd = -1;                            // 日志文件描述符
+    bool mapped = false;                    // 当前文件是否使用 mmap 方式
+    char* mapBase = nullptr;                // 当前映射窗口
+    uint64_t mapOffset = 0;                 // 映射窗口在文件中的偏移
+    size_t mapSize = 0;                     // 映射窗口大小
+    uint64_t allocatedBytes = 0;            // 文件已预先扩展到的长度
+    uint64_t syncedBytes = 0;               // 已 msync 的长度
+    size_t pageSize = 4096;                 // 页大小(打开文件时读取)
+    uint64_t* lengthMark = nullptr;         // 映射的逻辑长度记录(<文件>.len)
+    std::string lengthPath;                 // 逻辑长度记录文件路径
+#endif
+    LogFileSink sink = LOG_SINK_WRITE;      // 输出方式
+    bool compression = false;               // 是否流式压缩(下次 open 时生效)
+    bool compressing = false;               // 当前文件是否流式压缩
+#if defined(LOGGER_HAVE_ZLIB)
+    z_stream zstream;                       // 压缩流(每帧重置)
+    bool zstreamReady = false;              // 压缩流是否已初始化
+#endif
+    std::vector<char> frameOut;             // 压缩帧输出缓冲区
+    LogIndexWriter frameIndex;              // 帧索引(<文件>.idx)
+    bool owned = true;                      // 是否由本对象关闭句柄
+    std::vector<char> buffer;               // 写缓冲区
+    size_t used = 0;                        // 缓冲区已用字节数
+    uint64_t fileBytes = 0;                 // 当前文件大小(含未写出部分)
+    int64_t firstPendingNanos = 0;          // 缓冲区中最早数据的写入时间
+    LogFlushPolicy policy;                  // 刷盘策略
+    std::atomic<uint64_t> syscalls{0};      // write 系统调用次数
+    std::atomic<uint64_t> bytesWritten{0};  // 写入字节数
+    std::atomic<uint64_t> batches{0};       // 刷盘批次数
+    LogHistogram writeLatency;              // write 系统调用耗时
+    std::mutex sampleMtx;                   // 保护上次取统计的时间和系统调用次数
+    int64_t lastSampleNanos;                // 上次取统计的时间
+    uint64_t lastSampleSyscalls = 0;        // 上次取统计时的系统调用次数
+};
+
+#endif // LOGGER_WRITER_H
@@ -5,6 +5,7 @@
 int main() {
     // 初始化日志模块
     Logger::getInstance("./logs", "logger", LV_TRACE, true)->start();
+    int count = 0;
     while(1) {
         LOG_TRACE("This is a trace log message.");
         LOG_DEBUG("This is a debug log message.");
@@ -12,6 +13,8 @@ int main() {
         LOG_WARN("This is a warning log message.");
         LOG_ERROR("This is an error log message.");
         LOG_FATAL("This is a fatal log message.");
+        ++count;
+        LOGF_INFO("This is a {} log message, count={} ratio={}", "LOGF", count, count / 3.0);
         LOG_SLEEP(1000);
     }
     return 0;
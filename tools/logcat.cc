@@ -0,0 +1,458 @@
+// 日志查询工具: 解码二进制日志(.blog)并按文本日志的格式输出, 文本日志(.log)原样输出; 可按级别、时间范围和模块过滤
+// 用法: logcat [--level N] [--from 时间] [--to 时间] [--module 模块] [--precision s|ms|us|ns] [--verbose] 文件或目录...
+// 时间格式: "YYYY-MM-DD HH:MM:SS[.小数]"、"YYYY-MM-DD" 或纪元秒; 目录按 模块/日期/序号 顺序读取其中的 .log/.blog[.gz] 文件
+// 日志文件旁有索引文件(<文件>.idx)时, 按时间二分查找并只读取相关的块以及未被索引覆盖的部分
+// 流式压缩的日志文件(.log.gz/.blog.gz)按帧索引只解压选中的帧
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "logger.h"
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <dirent.h>
+#endif
+
+struct LogcatOptions {
+    int level = LV_TRACE;                   // 最低级别
+    int64_t from = INT64_MIN;               // 起始时间(纪元纳秒, 含)
+    int64_t to = INT64_MAX;                 // 结束时间(纪元纳秒, 不含)
+    std::string module;                     // 只输出该模块(空表示全部)
+    LogTimePrecision precision = LOG_TIME_MS;   // 时间戳精度
+    bool verbose = false;                   // 在标准错误输出每个文件读取的字节数
+};
+
+typedef std::pair<uint64_t, uint64_t> LogcatRange;  // 文件中的一段 [起始偏移, 结束偏移)
+
+static bool endsWith(const std::string& s, const char* suffix)
+{
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// 解析时间: 纪元秒, 或本地时间 "YYYY-MM-DD[ HH:MM:SS[.小数]]"
+static bool parseTime(const std::string& value, int64_t& nanos)
+{
+    char* end = nullptr;
+    long long seconds = std::strtoll(value.c_str(), &end, 10);
+    if (end != value.c_str() && *end == '\0') {
+        nanos = seconds * 1000000000LL;
+        return true;
+    }
+    std::tm tm_value;
+    std::memset(&tm_value, 0, sizeof(tm_value));
+    char frac[16] = "";
+    int n = std::sscanf(value.c_str(), "%d-%d-%d%*[ T]%d:%d:%d.%15[0-9]", &tm_value.tm_year, &tm_value.tm_mon, &tm_value.tm_mday,
+                        &tm_value.tm_hour, &tm_value.tm_min, &tm_value.tm_sec, frac);
+    if (n != 3 && n < 6) return false;
+    tm_value.tm_year -= 1900;
+    tm_value.tm_mon -= 1;
+    tm_value.tm_isdst = -1;
+    std::time_t t = std::mktime(&tm_value);
+    if (t == static_cast<std::time_t>(-1)) return false;
+    int64_t fraction = 0;   // 小数部分按 9 位纳秒补齐
+    size_t len = std::strlen(frac);
+    for (size_t i = 0; i < 9; ++i) fraction = fraction * 10 + (i < len ? frac[i] - '0' : 0);
+    nanos = static_cast<int64_t>(t) * 1000000000LL + fraction;
+    return true;
+}
+
+static bool readFile(const std::string& path, std::vector<char>& data)
+{
+    data.clear();
+    if (endsWith(path, ".gz")) {
+#if defined(LOGGER_HAVE_ZLIB)
+        gzFile in = gzopen(path.c_str(), "rb");
+        if (in == nullptr) return false;
+        char buffer[256 * 1024];
+        int n;
+        while ((n = gzread(in, buffer, sizeof(buffer))) > 0) data.insert(data.end(), buffer, buffer + n);
+        gzclose(in);
+        if (n < 0) std::fprintf(stderr, "logcat: %s: truncated or corrupted gzip data\n", path.c_str());  // 保留已解压的部分
+        return true;
+#else
+        std::fprintf(stderr, "logcat: %s: built without zlib\n", path.c_str());
+        return false;
+#endif
+    }
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// 目录中的日志文件按 (模块, 日期, 序号) 排序: <module>.<date>[.<index>].log|.blog[.gz]
+struct LogcatFile {
+    std::string path;
+    std::string module;
+    std::string date;
+    long index;
+    bool operator<(const LogcatFile& other) const {
+        if (module != other.module) return module < other.module;
+        if (date != other.date) return date < other.date;
+        return index < other.index;
+    }
+};
+
+static void listDirectory(const std::string& dir, std::vector<std::string>& files)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) return;
+    std::vector<LogcatFile> found;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != nullptr) {
+        std::string name = ent->d_name;
+        std::string stem = endsWith(name, ".gz") ? name.substr(0, name.size() - 3) : name;
+        if (endsWith(stem, ".blog")) stem.erase(stem.size() - 5);
+        else if (endsWith(stem, ".log")) stem.erase(stem.size() - 4);
+        else continue;
+        LogcatFile f;
+        f.path = dir + "/" + name;
+        f.index = 0;
+        size_t dot = stem.rfind('.');
+        if (dot != std::string::npos && stem.find_first_not_of("0123456789", dot + 1) == std::string::npos &&
+            stem.find('-', 0) != std::string::npos && stem.rfind('-') < dot) {   // 末尾为纯数字且前面有日期: 序号
+            f.index = std::strtol(stem.c_str() + dot + 1, nullptr, 10);
+            stem.erase(dot);
+        }
+        dot = stem.rfind('.');
+        f.module = dot == std::string::npos ? stem : stem.substr(0, dot);
+        f.date = dot == std::string::npos ? std::string() : stem.substr(dot + 1);
+        found.push_back(f);
+    }
+    closedir(d);
+    std::sort(found.begin(), found.end());
+    for (const LogcatFile& f : found) files.push_back(f.path);
+#else
+    (void)dir;
+    (void)files;
+#endif
+}
+
+static bool isDirectory(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && (st.st_mode & S_IFMT) == S_IFDIR;
+}
+
+static void addRange(std::vector<LogcatRange>& ranges, uint64_t begin, uint64_t end)
+{
+    if (begin >= end) return;
+    if (!ranges.empty() && ranges.back().second == begin) ranges.back().second = end;  // 合并相邻的范围
+    else ranges.push_back(LogcatRange(begin, end));
+}
+
+// 根据索引选出需要读取的范围: 与时间范围相交且出现过所需级别的块, 以及索引没有覆盖的部分
+// 块之间的时间只是近似有序, 用 maxNanos 的前缀最大值和 minNanos 的后缀最小值二分查找候选块
+static void selectRanges(std::vector<LogIndexEntry> entries, uint64_t size, const LogcatOptions& opts, std::vector<LogcatRange>& ranges)
+{
+    std::sort(entries.begin(), entries.end(), [](const LogIndexEntry& a, const LogIndexEntry& b) {
+        return a.offset < b.offset;
+    });
+    size_t n = entries.size();
+    std::vector<int64_t> prefixMax(n), suffixMin(n);
+    for (size_t i = 0; i < n; ++i) prefixMax[i] = std::max(entries[i].maxNanos, i > 0 ? prefixMax[i - 1] : INT64_MIN);
+    for (size_t i = n; i-- > 0;) suffixMin[i] = std::min(entries[i].minNanos, i + 1 < n ? suffixMin[i + 1] : INT64_MAX);
+    size_t lo = std::lower_bound(prefixMax.begin(), prefixMax.end(), opts.from) - prefixMax.begin();
+    size_t hi = std::lower_bound(suffixMin.begin(), suffixMin.end(), opts.to) - suffixMin.begin();
+    uint32_t levelMask = opts.level <= 0 ? ~0u : opts.level > LV_CLOSE ? 0u : ~0u << opts.level;
+    uint64_t pos = 0;   // 已处理到的偏移
+    for (size_t i = 0; i < n; ++i) {
+        const LogIndexEntry& e = entries[i];
+        uint64_t begin = std::min(e.offset, size);
+        uint64_t end = std::min(e.offset + e.length, size);
+        if (begin < pos) continue;  // 与前一块重叠(索引与文件不一致), 剩余部分按未索引处理
+        addRange(ranges, pos, begin);
+        if (i >= lo && i < hi && e.maxNanos >= opts.from && e.minNanos < opts.to && (e.levels & levelMask) != 0) {
+            addRange(ranges, begin, end);
+        }
+        pos = end;
+    }
+    addRange(ranges, pos, size);
+}
+
+// 文本日志行首的时间和级别: "[YYYY-MM-DD HH:MM:SS[.小数]] [级别] " 或崩溃转储的 "[纪元秒.纳秒] [级别] "
+class LogcatLineParser {
+public:
+    inline bool parse(const char* p, const char* end, int64_t& nanos, int& level) {
+        if (end - p < 3 || *p != '[') return false;
+        const char* q = p + 1;
+        int64_t seconds = 0;
+        if (end - q >= 19 && q[4] == '-' && q[7] == '-' && q[10] == ' ' && q[13] == ':' && q[16] == ':') {
+            if (!cached || std::memcmp(cachedKey, q, sizeof(cachedKey)) != 0) {    // 同一秒内的行只转换一次
+                std::string value(q, sizeof(cachedKey));
+                if (!parseTime(value, cachedSeconds)) return false;
+                std::memcpy(cachedKey, q, sizeof(cachedKey));
+                cached = true;
+            }
+            seconds = cachedSeconds;
+            q += sizeof(cachedKey);
+        } else if (q < end && *q >= '0' && *q <= '9') {
+            while (q < end && *q >= '0' && *q <= '9') seconds = seconds * 10 + (*q++ - '0');
+            seconds *= 1000000000LL;
+        } else {
+            return false;
+        }
+        int64_t fraction = 0;   // 小数部分按 9 位纳秒补齐
+        int digits = 0;
+        if (q < end && *q == '.') {
+            for (++q; q < end && *q >= '0' && *q <= '9'; ++q) {
+                if (digits < 9) fraction = fraction * 10 + (*q - '0'), ++digits;
+            }
+        }
+        for (; digits < 9; ++digits) fraction *= 10;
+        if (end - q < 2 || q[0] != ']' || q[1] != ' ') return false;
+        q += 2;
+        nanos = seconds + fraction;
+        level = LV_CLOSE;
+        if (q < end && *q == '[') {
+            const char* close = static_cast<const char*>(std::memchr(q, ']', std::min<ptrdiff_t>(end - q, 16)));
+            for (int i = LV_TRACE; close != nullptr && i < LV_CLOSE; ++i) {
+                const std::string& name = LogLevelNames[i];
+                if (static_cast<size_t>(close - q - 1) == name.size() && std::memcmp(q + 1, name.data(), name.size()) == 0) level = i;
+            }
+        }
+        return true;
+    }
+
+private:
+    char cachedKey[19];         // 上一次转换的 "YYYY-MM-DD HH:MM:SS"
+    int64_t cachedSeconds = 0;  // 对应的纪元纳秒
+    bool cached = false;
+};
+
+static void flushOutput(std::string& out)
+{
+    if (out.size() < 256 * 1024) return;
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    out.clear();
+}
+
+// 过滤一段文本日志, 不带时间的行(多行日志的后续行)跟随前一行
+static uint64_t filterText(const char* data, size_t size, const LogcatOptions& opts, LogcatLineParser& parser, std::string& out)
+{
+    uint64_t count = 0;
+    bool keep = opts.level <= LV_TRACE && opts.from == INT64_MIN && opts.to == INT64_MAX;
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* next = eol != nullptr ? eol + 1 : end;
+        int64_t nanos;
+        int level;
+        if (parser.parse(p, next, nanos, level)) {
+            keep = level >= opts.level && nanos >= opts.from && nanos < opts.to;
+            if (keep) ++count;
+        }
+        if (keep) {
+            out.append(p, next - p);
+            if (eol == nullptr) out += '\n';
+            flushOutput(out);
+        }
+        p = next;
+    }
+    return count;
+}
+
+// 解码一段二进制日志(索引块和未索引部分都从文件头记录开始)
+static uint64_t decodeBinary(const std::string& path, const char* data, size_t size, const LogcatOptions& opts,
+                             LogTimeFormatter& formatter, std::string& out)
+{
+    LogBinaryReader reader(data, size);
+    uint64_t count = 0;
+    while (reader.next()) {
+        int level = reader.currentLevel();
+        int64_t nanos = reader.currentNanos();
+        if (level < opts.level || nanos < opts.from || nanos >= opts.to) continue;
+        if (!opts.module.empty() && reader.module() != opts.module) continue;
+        char time[LogTimeFormatter::MAX_LENGTH];
+        out += '[';
+        out.append(time, formatter.format(nanos, time));
+        out += "] ";
+        if (level < LV_CLOSE) {
+            out += '[';
+            out += LogLevelNames[level];
+            out += "] ";
+        }
+        reader.format(out);
+        out += '\n';
+        ++count;
+        flushOutput(out);
+    }
+    if (reader.isCorrupted()) std::fprintf(stderr, "logcat: %s: truncated or corrupted record, stopped\n", path.c_str());
+    return count;
+}
+
+#if defined(LOGGER_HAVE_ZLIB)
+// 解压由若干完整 gzip 成员组成的一段数据(流式压缩文件的帧), 末尾不完整的成员保留已解压的部分
+static bool inflateFrames(const char* data, size_t size, std::vector<char>& out)
+{
+    out.clear();
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) return false;
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(size);
+    char chunk[64 * 1024];
+    int ret = Z_OK;
+    while (zs.avail_in > 0 || ret == Z_OK) {
+        zs.next_out = reinterpret_cast<Bytef*>(chunk);
+        zs.avail_out = sizeof(chunk);
+        ret = inflate(&zs, Z_NO_FLUSH);
+        out.insert(out.end(), chunk, chunk + sizeof(chunk) - zs.avail_out);
+        if (ret == Z_STREAM_END) {
+            if (zs.avail_in == 0) break;
+            inflateReset(&zs);  // 下一帧
+            ret = Z_OK;
+        } else if (ret != Z_OK || (zs.avail_in == 0 && zs.avail_out != 0)) {
+            break;
+        }
+    }
+    inflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+#endif
+
+// 读取一个文件中需要的范围并按过滤条件输出, 返回输出条数
+// 索引有三种: 普通文件的 <文件>.idx; 流式压缩文件的 <文件>.gz.idx(按帧, 偏移为压缩文件中的位置, 只解压选中的帧);
+// 归档压缩文件沿用的 <文件>.idx(偏移为解压后的位置, 整体解压后按范围过滤)
+static uint64_t decodeFile(const std::string& path, const LogcatOptions& opts, LogTimeFormatter& formatter, std::string& out)
+{
+    bool compressed = endsWith(path, ".gz");
+    std::string stem = compressed ? path.substr(0, path.size() - 3) : path;
+    bool binary = endsWith(stem, ".blog");
+    if (!binary && !opts.module.empty()) {  // 文本日志按文件名 <module>.<date>... 过滤模块
+        size_t slash = path.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+        if (name.compare(0, opts.module.size() + 1, opts.module + ".") != 0) return 0;
+    }
+    std::vector<LogIndexEntry> entries;
+    bool frames = compressed && logReadIndex(path + ".idx", entries);
+    bool indexed = frames || logReadIndex(stem + ".idx", entries);
+    std::vector<char> data;     // 归档压缩文件整体解压; 其余文件只读取选中的范围
+    std::ifstream in;
+    uint64_t size = 0;
+    if (compressed && !frames) {
+        if (!readFile(path, data)) {
+            std::fprintf(stderr, "logcat: cannot read %s\n", path.c_str());
+            return 0;
+        }
+        size = data.size();
+    } else {
+        in.open(path.c_str(), std::ios::binary);
+        if (!in || !in.seekg(0, std::ios::end)) {
+            std::fprintf(stderr, "logcat: cannot read %s\n", path.c_str());
+            return 0;
+        }
+        size = static_cast<uint64_t>(in.tellg());
+    }
+    std::vector<char> buffer;
+    std::vector<char> inflated;
+    auto read = [&](uint64_t begin, uint64_t end, size_t& length) -> const char* {
+        length = end - begin;
+        if (compressed && !frames) return data.data() + begin;
+        buffer.resize(length);
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(begin));
+        if (!in.read(buffer.data(), buffer.size())) return nullptr;
+        if (!frames) return buffer.data();
+#if defined(LOGGER_HAVE_ZLIB)
+        if (!inflateFrames(buffer.data(), buffer.size(), inflated)) {
+            std::fprintf(stderr, "logcat: %s: truncated or corrupted frame at offset %llu\n", path.c_str(),
+                         static_cast<unsigned long long>(begin));
+        }
+        length = inflated.size();
+        return inflated.data();
+#else
+        return nullptr;
+#endif
+    };
+    std::vector<LogcatRange> ranges;
+    selectRanges(entries, size, opts, ranges);
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    LogcatLineParser parser;
+    for (const LogcatRange& range : ranges) {
+        size_t length = 0;
+        const char* slice = read(range.first, range.second, length);
+        if (slice == nullptr) {
+            std::fprintf(stderr, "logcat: %s: read error\n", path.c_str());
+            break;
+        }
+        bytes += range.second - range.first;
+        if (binary) count += decodeBinary(path, slice, length, opts, formatter, out);
+        else count += filterText(slice, length, opts, parser, out);
+    }
+    if (opts.verbose) {
+        std::fprintf(stderr, "logcat: %s: %llu records, read %llu of %llu bytes in %zu ranges (%s)\n", path.c_str(),
+                     static_cast<unsigned long long>(count), static_cast<unsigned long long>(bytes),
+                     static_cast<unsigned long long>(size), ranges.size(),
+                     frames ? "frame index" : indexed ? "indexed" : "no index");
+    }
+    return count;
+}
+
+static void usage(const char* prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [--level 0-6] [--from TIME] [--to TIME] [--module NAME] [--precision s|ms|us|ns] [--verbose] FILE|DIR...\n"
+        "       TIME: \"YYYY-MM-DD HH:MM:SS[.frac]\", \"YYYY-MM-DD\" or epoch seconds (local time)\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    LogcatOptions opts;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            inputs.push_back(arg);
+            continue;
+        }
+        if (arg == "--verbose") {
+            opts.verbose = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--level") opts.level = std::atoi(value.c_str());
+        else if (arg == "--from") ok = parseTime(value, opts.from);
+        else if (arg == "--to") ok = parseTime(value, opts.to);
+        else if (arg == "--module") opts.module = value;
+        else if (arg == "--precision") {
+            if (value == "s") opts.precision = LOG_TIME_SEC;
+            else if (value == "ms") opts.precision = LOG_TIME_MS;
+            else if (value == "us") opts.precision = LOG_TIME_US;
+            else if (value == "ns") opts.precision = LOG_TIME_NS;
+            else ok = false;
+        } else ok = false;
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (inputs.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::vector<std::string> files;
+    for (const std::string& input : inputs) {
+        if (isDirectory(input)) listDirectory(input, files);
+        else files.push_back(input);
+    }
+    LogTimeFormatter formatter(opts.precision);
+    std::string out;
+    for (const std::string& file : files) decodeFile(file, opts, formatter, out);
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    return 0;
+}
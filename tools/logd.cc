@@ -0,0 +1,169 @@
+// 日志采集进程: 取出各进程共享内存环形队列(transport=shm)中的日志, 按时间戳归并后由本进程的 Logger 批量写入 <模块>.<日期>.log
+// 用法: logd [--dir 目录] [--module 模块] [--config 配置文件] [--interval-ms N] [--console] [--once]
+// 每条日志前加 "[<来源模块>:<pid>] "; 来源进程正常停止或退出(包括崩溃)后, 取空它的队列并删除共享内存段
+// 日志文件的刷盘、切换、压缩、格式等按 --config 指定的配置文件(默认 ./logd.conf, 格式同 logger.conf, 不能设置 transport=shm)
+// logd 重启后从共享内存中保存的读位置继续, 已提交的日志不会丢失
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include "logger.h"
+#include <dirent.h>
+
+struct LogdSource {
+    std::unique_ptr<LogShmReader> reader;
+    std::string prefix;     // "[<来源模块>:<pid>] "
+    LogShmRecord record;    // 已读出的队头日志
+    bool ready = false;     // record 是否有效
+};
+
+struct LogdOptions {
+    std::string dir = "./logs";         // 日志目录
+    std::string module = "logd";        // 输出文件的模块名
+    std::string config = "./logd.conf"; // 配置文件
+    int intervalMs = 10;                // 没有日志时的轮询间隔(毫秒)
+    bool console = false;               // 同时输出到终端
+    bool once = false;                  // 取空现有队列后退出
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStop(int)
+{
+    stopRequested = 1;
+}
+
+// 扫描 LOG_SHM_DIR, 登记新出现的共享内存段(尚未初始化完成的段下次扫描时再试)
+static void scanSegments(Logger* logger, std::map<std::string, LogdSource>& sources)
+{
+    DIR* dir = opendir(LOG_SHM_DIR);
+    if (dir == nullptr) return;
+    const size_t prefixLength = std::strlen(LOG_SHM_PREFIX);
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (std::strncmp(entry->d_name, LOG_SHM_PREFIX, prefixLength) != 0) continue;
+        std::string name = std::string("/") + entry->d_name;
+        if (sources.count(name) != 0) continue;
+        std::unique_ptr<LogShmReader> reader(new LogShmReader());
+        if (!reader->attach(name)) continue;
+        LogdSource& source = sources[name];
+        source.prefix = std::string("[") + reader->module() + ":" + std::to_string(static_cast<long long>(reader->pid())) + "] ";
+        source.reader = std::move(reader);
+        logger->log(LV_INFO, "[logd] attach %s", name.c_str());
+    }
+    closedir(dir);
+}
+
+// 按时间戳归并各队列中已发布的日志, 最多转发 limit 条; 返回转发条数
+// 只比较各队列当前的队头, 之后才发布的更早的日志按到达顺序写出
+static size_t collect(Logger* logger, std::map<std::string, LogdSource>& sources, size_t limit, std::string& line)
+{
+    size_t count = 0;
+    while (count < limit) {
+        LogdSource* next = nullptr;
+        for (std::map<std::string, LogdSource>::iterator it = sources.begin(); it != sources.end(); ++it) {
+            LogdSource& source = it->second;
+            if (!source.ready) source.ready = source.reader->peek(source.record);
+            if (source.ready && (next == nullptr || source.record.nanos < next->record.nanos)) next = &source;
+        }
+        if (next == nullptr) break;
+        line.assign(next->prefix);
+        line.append(next->record.text);
+        int level = next->record.level <= LV_CLOSE ? next->record.level : LV_CLOSE;
+        logger->logRecord(static_cast<LogLevel>(level), next->record.nanos, line.data(), line.size());
+        next->reader->pop();
+        next->ready = false;
+        ++count;
+    }
+    return count;
+}
+
+// 删除生产者已结束且已取空的共享内存段
+static void reap(Logger* logger, std::map<std::string, LogdSource>& sources)
+{
+    for (std::map<std::string, LogdSource>::iterator it = sources.begin(); it != sources.end();) {
+        LogdSource& source = it->second;
+        if (source.ready || !source.reader->finished() || !source.reader->drained()) {
+            ++it;
+            continue;
+        }
+        if (source.reader->skipped() > 0) {
+            logger->log(LV_WARN, "[logd] %s: skipped %llu cells left unpublished by a crashed writer", it->first.c_str(),
+                        static_cast<unsigned long long>(source.reader->skipped()));
+        }
+        logger->log(LV_INFO, "[logd] detach %s", it->first.c_str());
+        source.reader->detach(true);
+        sources.erase(it++);
+    }
+}
+
+static void usage(const char* prog)
+{
+    std::fprintf(stderr, "usage: %s [--dir DIR] [--module NAME] [--config FILE] [--interval-ms N] [--console] [--once]\n", prog);
+}
+
+int main(int argc, char* argv[])
+{
+    LogdOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--console") {
+            opts.console = true;
+            continue;
+        }
+        if (arg == "--once") {
+            opts.once = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--dir") opts.dir = value;
+        else if (arg == "--module") opts.module = value;
+        else if (arg == "--config") opts.config = value;
+        else if (arg == "--interval-ms") opts.intervalMs = std::max(1, std::atoi(value.c_str()));
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    std::signal(SIGINT, onStop);
+    std::signal(SIGTERM, onStop);
+
+    Logger* logger = Logger::getInstance(opts.dir, opts.module, LV_TRACE, opts.console);
+    logger->setConfigFile(opts.config);
+    logger->setTransport(LOG_TRANSPORT_FILE);
+    logger->start();
+    if (logger->getTransport() != LOG_TRANSPORT_FILE) {
+        std::fprintf(stderr, "logd: %s must not set transport=shm\n", opts.config.c_str());
+        return 1;
+    }
+    std::map<std::string, LogdSource> sources;
+    std::string line;
+    int64_t lastScan = 0;
+    while (!stopRequested) {
+        int64_t now = LogClock::nowNanos();
+        if (now - lastScan >= 1000000000LL) {   // 每秒扫描一次新进程
+            scanSegments(logger, sources);
+            lastScan = now;
+        }
+        for (std::map<std::string, LogdSource>::iterator it = sources.begin(); it != sources.end(); ++it) {
+            it->second.reader->heartbeat(now);
+        }
+        size_t count = collect(logger, sources, 4096, line);
+        reap(logger, sources);
+        if (count == 0) {
+            if (opts.once) break;
+            LOG_SLEEP(opts.intervalMs);
+        }
+    }
+    while (collect(logger, sources, 4096, line) > 0) {}   // 退出前取空已发布的日志
+    reap(logger, sources);
+    logger->shutdown();
+    return 0;
+}